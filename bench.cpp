@@ -0,0 +1,287 @@
+// bench.cpp - jsonify benchmark suite and synthetic corpus generator
+//
+//   jsonify_bench [--size MB] [--iterations N] [--only CORPUS]
+//   jsonify_bench --generate CORPUS [--size MB] > corpus.json
+//
+// Results are printed one JSON object per line (NDJSON) so runs of different
+// builds can be diffed or loaded into a spreadsheet.
+#include "jsonalloc.h"
+#include "jsonbind.h"
+#include "jsonparser.h"
+#include "jsonformatter.h"
+#include "jsonlinter.h"
+#include "jsonstats.h"
+#include <algorithm>
+#include <chrono>
+#include <cstddef>
+#include <cstdint>
+#include <cstdio>
+#include <cstdlib>
+#include <iostream>
+#include <memory_resource>
+#include <optional>
+#include <sstream>
+#include <string>
+#include <vector>
+
+/* --------------------------------------------------------------- */
+// Deterministic corpus generator (xorshift64*), so every build sees the same input.
+class Rng {
+public:
+    explicit Rng(uint64_t seed) : s_(seed) {}
+    uint64_t next() {
+        s_ ^= s_ >> 12; s_ ^= s_ << 25; s_ ^= s_ >> 27;
+        return s_ * 0x2545F4914F6CDD1DULL;
+    }
+    uint64_t below(uint64_t n) { return next() % n; }
+private:
+    uint64_t s_;
+};
+
+static void appendNumber(std::string& out, Rng& rng) {
+    char buf[64];
+    switch (rng.below(3)) {
+        case 0: std::snprintf(buf, sizeof buf, "%lld", static_cast<long long>(rng.below(2000000)) - 1000000); break;
+        case 1: std::snprintf(buf, sizeof buf, "%.6f", static_cast<double>(rng.below(100000000)) / 997.0); break;
+        default: std::snprintf(buf, sizeof buf, "%.3e", static_cast<double>(rng.below(1000000)) * 1e10); break;
+    }
+    out += buf;
+}
+
+static void appendString(std::string& out, Rng& rng, bool escapes) {
+    static const char* words[] = {"alpha", "beta", "gamma", "delta", "path", "value", "name", "x"};
+    static const char* escs[]  = {"\\n", "\\t", "\\\"", "\\\\", "\\/", "\\u00e9", "\\u4e2d", "\\ud83d\\ude00"};
+    out += '"';
+    size_t parts = 1 + rng.below(6);
+    for (size_t i = 0; i < parts; ++i) {
+        if (i) out += ' ';
+        out += words[rng.below(8)];
+        if (escapes && rng.below(2)) out += escs[rng.below(8)];
+    }
+    out += '"';
+}
+
+static void appendSmallObject(std::string& out, Rng& rng, uint64_t id, bool comments) {
+    out += "{\"id\":" + std::to_string(id) + ",\"name\":";
+    appendString(out, rng, false);
+    if (comments) out += " /* display name */";
+    out += ",\"active\":";
+    out += rng.below(2) ? "true" : "false";
+    out += ",\"score\":";
+    appendNumber(out, rng);
+    out += ",\"tags\":[\"a\",\"b\"],\"parent\":null}";
+}
+
+static void appendDeep(std::string& out, Rng& rng, int depth) {
+    if (depth == 0) { appendNumber(out, rng); return; }
+    if (depth % 2) { out += "{\"child\":"; appendDeep(out, rng, depth - 1); out += '}'; }
+    else           { out += '[';           appendDeep(out, rng, depth - 1); out += ']'; }
+}
+
+// The record shape of the objects corpus, for the typed-binding rows.
+struct BenchRecord {
+    long long id = 0;
+    std::string name;
+    bool active = false;
+    double score = 0;
+    std::vector<std::string> tags;
+    std::optional<long long> parent;
+};
+
+template <> struct JsonBinding<BenchRecord> {
+    static constexpr auto fields = std::make_tuple(
+        jsonField("id", &BenchRecord::id),
+        jsonField("name", &BenchRecord::name),
+        jsonField("active", &BenchRecord::active),
+        jsonField("score", &BenchRecord::score),
+        jsonField("tags", &BenchRecord::tags),
+        jsonField("parent", &BenchRecord::parent));
+};
+
+static const char* const CORPORA[] = {"numbers", "strings", "deep", "objects", "ndjson", "jsonc"};
+
+// Builds roughly `bytes` of the named corpus.
+static std::string generateCorpus(const std::string& kind, size_t bytes) {
+    Rng rng(0x6A736F6E69667921ULL);   // "jsonify!"
+    std::string out;
+    out.reserve(bytes + 4096);
+    const bool ndjson = kind == "ndjson";
+    if (!ndjson) out += '[';
+    for (uint64_t i = 0; out.size() < bytes; ++i) {
+        if (i && !ndjson) out += kind == "jsonc" ? ",\n" : ",";
+        if (kind == "numbers")      appendNumber(out, rng);
+        else if (kind == "strings") appendString(out, rng, true);
+        else if (kind == "deep")    appendDeep(out, rng, 64);
+        else if (kind == "objects") appendSmallObject(out, rng, i, false);
+        else if (kind == "ndjson")  { appendSmallObject(out, rng, i, false); out += '\n'; }
+        else if (kind == "jsonc") {
+            if (i % 4 == 0) out += "// record " + std::to_string(i) + "\n";
+            appendSmallObject(out, rng, i, true);
+        }
+        else throw std::runtime_error("Unknown corpus: " + kind);
+    }
+    if (!ndjson) out += ']';
+    return out;
+}
+
+/* --------------------------------------------------------------- */
+static size_t countNodes(const std::shared_ptr<JsonValue>& v) {
+    if (!v) return 1;
+    size_t n = 1;
+    if (v->getType() == JsonValue::Type::Array)
+        for (const auto& el : v->getArray()) n += countNodes(el);
+    else if (v->getType() == JsonValue::Type::Object)
+        for (const auto& kv : v->getObject()) n += countNodes(kv.second);
+    return n;
+}
+
+static std::vector<std::string> splitLines(const std::string& text) {
+    std::vector<std::string> lines;
+    size_t start = 0;
+    while (start < text.size()) {
+        size_t nl = text.find('\n', start);
+        if (nl == std::string::npos) nl = text.size();
+        if (nl > start) lines.emplace_back(text, start, nl - start);
+        start = nl + 1;
+    }
+    return lines;
+}
+
+struct Measurement {
+    double   seconds = 0;       // median wall time of one iteration
+    uint64_t allocations = 0;   // per iteration
+    uint64_t allocBytes = 0;    // per iteration
+    size_t   bytes = 0;         // bytes processed per iteration
+};
+
+// Runs `op` `iterations` times; `op` returns the number of bytes it processed.
+template <class Op>
+static Measurement measure(int iterations, Op op) {
+    std::vector<double> times;
+    Measurement m;
+    for (int i = 0; i < iterations; ++i) {
+        uint64_t c0 = allocationCount(), b0 = allocationBytes();
+        auto t0 = std::chrono::steady_clock::now();
+        m.bytes = op();
+        auto t1 = std::chrono::steady_clock::now();
+        m.allocations = allocationCount() - c0;
+        m.allocBytes  = allocationBytes() - b0;
+        times.push_back(std::chrono::duration<double>(t1 - t0).count());
+    }
+    std::sort(times.begin(), times.end());
+    m.seconds = times[times.size() / 2];
+    return m;
+}
+
+static void report(const std::string& bench, const std::string& corpus,
+                   size_t nodes, int iterations, const Measurement& m) {
+    double mbps = m.seconds > 0 ? m.bytes / m.seconds / 1e6 : 0;
+    double nsPerNode = nodes ? m.seconds * 1e9 / nodes : 0;
+    char line[512];
+    std::snprintf(line, sizeof line,
+        "{\"bench\":\"%s\",\"corpus\":\"%s\",\"bytes\":%zu,\"nodes\":%zu,\"iterations\":%d,"
+        "\"seconds\":%.6f,\"mb_per_s\":%.2f,\"ns_per_node\":%.2f,"
+        "\"allocations\":%llu,\"alloc_bytes\":%llu,\"peak_rss_kb\":%ld}",
+        bench.c_str(), corpus.c_str(), m.bytes, nodes, iterations,
+        m.seconds, mbps, nsPerNode,
+        static_cast<unsigned long long>(m.allocations),
+        static_cast<unsigned long long>(m.allocBytes), peakRssKb());
+    std::cout << line << std::endl;
+}
+
+/* --------------------------------------------------------------- */
+static void runCorpus(const std::string& kind, size_t bytes, int iterations) {
+    const std::string text = generateCorpus(kind, bytes);
+
+    if (kind == "ndjson") {
+        const auto lines = splitLines(text);
+        size_t nodes = 0;
+        for (const auto& l : lines) nodes += countNodes(JsonParser::parse(l));
+        report("parse", kind, nodes, iterations, measure(iterations, [&] {
+            for (const auto& l : lines) JsonParser::parse(l);
+            return text.size();
+        }));
+        return;
+    }
+
+    const bool jsonc = kind == "jsonc";
+    auto parse = [&] { return jsonc ? JsoncParser::parse(text) : JsonParser::parse(text); };
+    auto root = parse();
+    const size_t nodes = countNodes(root);
+
+    report(jsonc ? "parse-jsonc" : "parse", kind, nodes, iterations,
+           measure(iterations, [&] { parse(); return text.size(); }));
+
+    // Same parse with the DOM in a reused arena: teardown is a single release()
+    std::pmr::monotonic_buffer_resource arena;
+    report(jsonc ? "parse-jsonc-arena" : "parse-arena", kind, nodes, iterations,
+           measure(iterations, [&] {
+               {
+                   auto doc = jsonc ? JsoncParser::parse(text, &arena) : JsonParser::parse(text, &arena);
+               }
+               arena.release();
+               return text.size();
+           }));
+
+    if (kind == "objects") {
+        std::vector<BenchRecord> records;
+        report("bind", kind, nodes, iterations, measure(iterations, [&] {
+            fromJson(text, records);
+            return text.size();
+        }));
+        report("bind-write", kind, nodes, iterations, measure(iterations, [&] {
+            std::ostringstream os;
+            writeJson(records, os, 0, 2, true);
+            return os.str().size();
+        }));
+    }
+
+    struct Layout { const char* name; bool compact; bool color; };
+    for (const Layout& l : {Layout{"format-pretty", false, false},
+                            Layout{"format-compact", true, false},
+                            Layout{"format-color", false, true}}) {
+        report(l.name, kind, nodes, iterations, measure(iterations, [&] {
+            std::ostringstream os;
+            printJson(root, os, 0, 2, l.compact, l.color);
+            return os.str().size();
+        }));
+    }
+
+    report("lint", kind, nodes, iterations,
+           measure(iterations, [&] { lintJson(root, text); return text.size(); }));
+}
+
+int main(int argc, char* argv[]) {
+    size_t sizeMb = 8;
+    int iterations = 5;
+    std::string only, generate;
+
+    for (int i = 1; i < argc; ++i) {
+        std::string arg = argv[i];
+        if (arg == "--size" && i+1 < argc)            sizeMb = std::stoul(argv[++i]);
+        else if (arg == "--iterations" && i+1 < argc) iterations = std::max(1, std::stoi(argv[++i]));
+        else if (arg == "--only" && i+1 < argc)       only = argv[++i];
+        else if (arg == "--generate" && i+1 < argc)   generate = argv[++i];
+        else {
+            std::cerr << "Usage: jsonify_bench [--size MB] [--iterations N] [--only CORPUS]\n"
+                         "       jsonify_bench --generate CORPUS [--size MB]\n"
+                         "Corpora: numbers strings deep objects ndjson jsonc\n";
+            return arg == "--help" ? 0 : 1;
+        }
+    }
+
+    setAllocationCounting(true);
+    try {
+        if (!generate.empty()) {
+            std::cout << generateCorpus(generate, sizeMb << 20);
+            return 0;
+        }
+        for (const char* kind : CORPORA) {
+            if (only.empty() || only == kind) runCorpus(kind, sizeMb << 20, iterations);
+        }
+    } catch (const std::exception& e) {
+        std::cerr << "Error: " << e.what() << '\n';
+        return 1;
+    }
+    return 0;
+}
@@ -0,0 +1,131 @@
+// binary_test.cpp
+#include "jsonparser.h"
+#include "jsonbinary.h"
+#include <iostream>
+#include <string>
+#include <iomanip>
+#include <vector>
+#include <memory>
+
+// Very simple recursive equality check for JsonValue trees
+bool json_equal(const std::shared_ptr<JsonValue>& a,
+                const std::shared_ptr<JsonValue>& b) {
+    if (!a || !b) return a == b;
+    if (a->getType() != b->getType()) return false;
+
+    switch (a->getType()) {
+        case JsonValue::Type::Null:   return true;
+        case JsonValue::Type::Bool:   return a->getBool()   == b->getBool();
+        case JsonValue::Type::Number: return a->getNumber() == b->getNumber();
+        case JsonValue::Type::String: return a->getString() == b->getString();
+
+        case JsonValue::Type::Array: {
+            const auto& arrA = a->getArray();
+            const auto& arrB = b->getArray();
+            if (arrA.size() != arrB.size()) return false;
+            for (size_t i = 0; i < arrA.size(); ++i) {
+                if (!json_equal(arrA[i], arrB[i])) return false;
+            }
+            return true;
+        }
+
+        case JsonValue::Type::Object: {
+            const auto& objA = a->getObject();
+            const auto& objB = b->getObject();
+            if (objA.size() != objB.size()) return false;
+            for (const auto& [key, valA] : objA) {
+                auto it = objB.find(key);
+                if (it == objB.end() || !json_equal(valA, it->second)) {
+                    return false;
+                }
+            }
+            return true;
+        }
+    }
+    return false; // unreachable
+}
+
+struct BinaryTest {
+    std::string input;
+    std::string description;
+};
+
+// Round-trip text -> binary -> JsonValue and compare the trees
+void run_binary_test(const BinaryTest& t) {
+    std::cout << std::left << std::setw(38) << ("[" + t.description + "]")
+              << " → ";
+    try {
+        auto original = JsonParser::parse(t.input);
+        std::string bin = toJsonBinary(original);
+        JsonBinaryView view(bin.data(), bin.size());
+
+        if (json_equal(original, view.root().toValue())) std::cout << "PASS\n";
+        else std::cout << "FAIL (structure changed after binary round-trip)\n";
+    } catch (const std::exception& e) {
+        std::cout << "FAIL (exception: " << e.what() << ")\n";
+    }
+}
+
+int main() {
+    std::cout << "=== JSON Binary Format Tests ===\n\n";
+
+    std::vector<BinaryTest> tests = {
+        {"null",                              "null root"},
+        {"[true,false,null]",                 "literals"},
+        {"[0,-1.5,1e300,123456789012]",       "numbers"},
+        {R"("esc \" \\ \n é")",          "string escapes"},
+        {R"({"b":[1,{"c":"d"}],"a":{}})",     "nested containers"},
+        {"[]",                                "empty array"},
+    };
+    for (const auto& t : tests) run_binary_test(t);
+
+    // In-place access without deserializing the whole document
+    std::cout << std::left << std::setw(38) << "[view lookup without toValue]" << " → ";
+    try {
+        std::string bin = toJsonBinary(JsonParser::parse(R"({"zeta":1,"alpha":[10,20,30],"mid":"x"})"));
+        JsonBinaryView view(bin.data(), bin.size());
+        auto alpha = view.root().find("alpha");
+        bool ok = alpha && alpha->size() == 3 && alpha->at(1).getNumber() == 20
+                  && view.root().find("mid")->getString() == "x"
+                  && !view.root().find("missing");
+        std::cout << (ok ? "PASS\n" : "FAIL\n");
+    } catch (const std::exception& e) {
+        std::cout << "FAIL (exception: " << e.what() << ")\n";
+    }
+
+    std::cout << std::left << std::setw(38) << "[truncated document rejected]" << " → ";
+    try {
+        std::string bin = toJsonBinary(JsonParser::parse("[1,2,3]"));
+        bin.resize(bin.size() - 4);
+        JsonBinaryView view(bin.data(), bin.size());
+        view.root().toValue();
+        std::cout << "FAIL (loaded truncated data)\n";
+    } catch (const std::exception&) {
+        std::cout << "PASS (rejected as expected)\n";
+    }
+
+    // A child pointing back at its parent must not recurse forever
+    std::cout << std::left << std::setw(38) << "[cyclic offset rejected]" << " → ";
+    try {
+        std::string bin = toJsonBinary(JsonParser::parse("[[1]]"));
+        bin.replace(29, 8, std::string("\x18\0\0\0\0\0\0\0", 8)); // root element -> root (offset 24)
+        JsonBinaryView view(bin.data(), bin.size());
+        view.root().toValue();
+        std::cout << "FAIL (loaded cyclic data)\n";
+    } catch (const std::runtime_error&) {
+        std::cout << "PASS (rejected as expected)\n";
+    }
+
+    std::cout << std::left << std::setw(38) << "[excessive nesting rejected]" << " → ";
+    try {
+        size_t depth = JsonBinaryView::Node::kMaxDepth + 1;
+        std::string bin = toJsonBinary(JsonParser::parse(std::string(depth, '[') + std::string(depth, ']')));
+        JsonBinaryView view(bin.data(), bin.size());
+        view.root().toValue();
+        std::cout << "FAIL (loaded over-deep data)\n";
+    } catch (const std::runtime_error&) {
+        std::cout << "PASS (rejected as expected)\n";
+    }
+
+    return 0;
+}
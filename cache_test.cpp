@@ -0,0 +1,94 @@
+// cache_test.cpp
+#include "jsoncache.h"
+#include <chrono>
+#include <cstdio>
+#include <filesystem>
+#include <cstdlib>
+#include <fstream>
+#include <iomanip>
+#include <iostream>
+#include <sstream>
+#include <string>
+
+void report(const std::string& description, bool ok) {
+    std::cout << std::left << std::setw(38) << ("[" + description + "]")
+              << " → " << (ok ? "PASS" : "FAIL") << '\n';
+}
+
+std::string readFile(const std::filesystem::path& path) {
+    std::ifstream in(path, std::ios::binary);
+    std::ostringstream ss;
+    ss << in.rdbuf();
+    return ss.str();
+}
+
+int main(int argc, char** argv) {
+    std::cout << "=== JSON Cache Tests ===\n\n";
+
+    namespace fs = std::filesystem;
+    fs::path dir  = fs::temp_directory_path() / "jsonify_cache_test";
+    fs::path file = fs::temp_directory_path() / "jsonify_cache_test.json";
+    fs::remove_all(dir);
+
+    std::string content = R"({"a_b": 1})";
+    std::ofstream(file) << content;
+
+    try {
+        JsonCache cache(dir.string());
+        JsonCacheEntry entry;
+        report("empty cache misses", !cache.lookup(file.string(), content, 0, entry));
+
+        JsonCacheEntry stored;
+        stored.hasLint = true;
+        stored.issues.push_back({JsonLintIssue::Severity::Warning, "Key does not follow camelCase: a_b", -1, -1});
+        stored.snapshot = "snapshot-bytes";
+        cache.store(file.string(), content, 0, stored);
+
+        bool hit = cache.lookup(file.string(), content, 0, entry);
+        report("stored entry hits", hit && entry.hasLint && entry.issues.size() == 1
+                                    && entry.issues[0].line == -1
+                                    && entry.issues[0].message == stored.issues[0].message
+                                    && entry.snapshot == stored.snapshot);
+
+        report("other options miss", !cache.lookup(file.string(), content, 1, entry));
+        report("changed content misses", !cache.lookup(file.string(), R"({"a_c": 1})", 0, entry));
+        report("hash depends on content", hashBytes("abcdefgh1") != hashBytes("abcdefgh2"));
+
+        // The stat-only path: a file written just now is not trusted by its
+        // mtime, an older one is until it is touched.
+        report("fresh mtime needs content", !cache.lookup(file.string(), 0, entry));
+        const auto past = fs::file_time_type::clock::now() - std::chrono::hours(1);
+        fs::last_write_time(file, past);
+        cache.store(file.string(), content, 0, stored);
+        report("unchanged size and mtime hit", cache.lookup(file.string(), 0, entry) && entry.issues.size() == 1);
+        fs::last_write_time(file, past + std::chrono::minutes(1));
+        bool statMiss = !cache.lookup(file.string(), 0, entry);
+        bool verified = cache.lookup(file.string(), content, 0, entry);
+        report("touched file verified by hash", statMiss && verified && cache.lookup(file.string(), 0, entry));
+    } catch (const std::exception& e) {
+        std::cout << "FAIL (exception: " << e.what() << ")\n";
+    }
+
+    // A warm run must print exactly what the cold run printed. Needs the
+    // jsonify executable (first argument, default ./jsonify).
+    const std::string exe = argc > 1 ? argv[1] : "./jsonify";
+    if (!fs::exists(exe)) {
+        std::cout << "(" << exe << " not found, skipping cold/warm run test)\n";
+    } else {
+        fs::remove_all(dir);
+        std::string doc = "{";
+        for (int i = 0; i < 40; ++i) doc += (i ? ", \"k" : "\"k") + std::to_string(i) + "\": " + std::to_string(i);
+        std::ofstream(file) << doc << "}";
+        fs::path cold = fs::temp_directory_path() / "jsonify_cache_test.cold";
+        fs::path warm = fs::temp_directory_path() / "jsonify_cache_test.warm";
+        const std::string cmd = exe + " --format --cache-dir " + dir.string() + " " + file.string() + " > ";
+        bool ran = std::system((cmd + cold.string()).c_str()) == 0 && std::system((cmd + warm.string()).c_str()) == 0;
+        report("warm --format matches cold", ran && readFile(cold) == readFile(warm) && !readFile(warm).empty());
+        fs::remove(cold);
+        fs::remove(warm);
+    }
+
+    fs::remove_all(dir);
+    fs::remove(file);
+    return 0;
+}
@@ -0,0 +1,111 @@
+// compress_test.cpp
+#include "jsoncompress.h"
+#include "jsonparser.h"
+#include <cstdlib>
+#include <filesystem>
+#include <fstream>
+#include <iomanip>
+#include <iostream>
+#include <string>
+#include <thread>
+
+void report(const std::string& description, bool ok) {
+    std::cout << std::left << std::setw(38) << ("[" + description + "]")
+              << " → " << (ok ? "PASS" : "FAIL") << '\n';
+}
+
+void writeFile(const std::string& file, const std::string& text) {
+    std::ofstream(file, std::ios::binary) << text;
+}
+
+std::string readFile(const std::string& file) {
+    std::ifstream f(file, std::ios::binary);
+    return std::string(std::istreambuf_iterator<char>(f), std::istreambuf_iterator<char>());
+}
+
+// Everything the reader yields, with a small ring so the producer has to
+// wait for the consumer many times.
+std::string drain(const std::string& file, size_t bufferBytes, size_t buffers) {
+    JsonCompressedReader reader(file, bufferBytes, buffers);
+    std::string text;
+    for (std::string_view chunk = reader.next(); !chunk.empty(); chunk = reader.next()) text.append(chunk);
+    return text;
+}
+
+bool throws(const std::string& file) {
+    try { readJsonInput(file); } catch (const std::exception&) { return true; }
+    return false;
+}
+
+int main() {
+    std::cout << "=== Compressed Input Tests ===\n\n";
+
+    namespace fs = std::filesystem;
+    const std::string dir = (fs::temp_directory_path() / "jsonify_compress_test").string();
+    fs::remove_all(dir);
+    fs::create_directories(dir);
+
+    std::string text = "[";
+    for (int i = 0; i < 20000; ++i) text += (i ? ", " : "") + std::string("{\"id\": ") + std::to_string(i) + "}";
+    text += "]";
+    const std::string plain = dir + "/doc.json";
+    writeFile(plain, text);
+
+    try {
+        report("plain detected", detectCompression(plain) == JsonCompression::None);
+        report("plain passthrough", readJsonInput(plain) == text);
+        report("plain through the ring", drain(plain, 7, 2) == text);
+        report("missing file", throws(dir + "/none.json"));
+
+        // The gzip tool writes the fixtures; skip when it is not installed.
+        if (std::system(("gzip -c " + plain + " > " + plain + ".gz 2>/dev/null").c_str()) != 0) {
+            std::cout << "(gzip not available, skipping gzip tests)\n";
+        } else {
+            const std::string gz = plain + ".gz";
+            report("gzip detected", detectCompression(gz) == JsonCompression::Gzip);
+#ifdef JSONIFY_WITH_ZLIB
+            report("gzip round trip", readJsonInput(gz) == text);
+            report("gzip through a small ring", drain(gz, 7, 2) == text);
+            report("gzip parses", JsonParser::parse(readJsonInput(gz))->getArray().size() == 20000);
+
+            // Members written back to back decompress as one stream.
+            writeFile(dir + "/a.json", "[1, ");
+            writeFile(dir + "/b.json", "2]");
+            std::system(("gzip -c " + dir + "/a.json > " + dir + "/ab.gz && gzip -c " + dir
+                         + "/b.json >> " + dir + "/ab.gz").c_str());
+
+            // A pipe can be read only once: the magic bytes must not be lost.
+            const std::string fifo = dir + "/pipe";
+            if (std::system(("mkfifo " + fifo).c_str()) == 0) {
+                std::thread writer([&] { writeFile(fifo, readFile(gz)); });
+                bool same = readJsonInput(fifo) == text;
+                writer.join();
+                report("gzip from a pipe", same);
+            }
+            report("concatenated gzip members", readJsonInput(dir + "/ab.gz") == "[1, 2]");
+
+            std::string bytes = readFile(gz);
+            writeFile(dir + "/cut.gz", bytes.substr(0, bytes.size() / 2));
+            report("truncated gzip", throws(dir + "/cut.gz"));
+            bytes[bytes.size() / 2] = static_cast<char>(bytes[bytes.size() / 2] ^ 0x55);
+            bytes[bytes.size() / 2 + 1] = static_cast<char>(bytes[bytes.size() / 2 + 1] ^ 0x55);
+            writeFile(dir + "/bad.gz", bytes);
+            report("corrupt gzip", throws(dir + "/bad.gz"));
+
+            // Destroying the reader mid-stream stops the reader thread.
+            {
+                JsonCompressedReader reader(gz, 64, 2);
+                reader.next();
+            }
+            report("abandoned reader", true);
+#else
+            report("gzip without zlib", throws(gz));
+#endif
+        }
+    } catch (const std::exception& e) {
+        std::cout << "FAIL (exception: " << e.what() << ")\n";
+    }
+
+    fs::remove_all(dir);
+    return 0;
+}
@@ -0,0 +1,73 @@
+// diff_test.cpp
+#include "jsondiff.h"
+#include <iomanip>
+#include <iostream>
+#include <string>
+#include <vector>
+
+void report(const std::string& description, bool ok) {
+    std::cout << std::left << std::setw(38) << ("[" + description + "]")
+              << " → " << (ok ? "PASS" : "FAIL") << '\n';
+}
+
+// "+/a", "-/b", "~/c" for each difference, in order
+std::string summarize(const std::vector<JsonDifference>& diffs) {
+    std::string s;
+    for (const auto& d : diffs) {
+        if (!s.empty()) s += ' ';
+        s += d.kind == JsonDifference::Kind::Added ? '+' : d.kind == JsonDifference::Kind::Removed ? '-' : '~';
+        s += d.path;
+    }
+    return s;
+}
+
+void expectDiff(const std::string& description, const std::string& a, const std::string& b,
+                const std::string& expected) {
+    std::string got = summarize(diffJson(JsonParser::parse(a), JsonParser::parse(b)));
+    report(description, got == expected);
+    if (got != expected) std::cout << "  (got: " << got << ")\n";
+}
+
+std::string bigArray(size_t n, size_t changed) {
+    std::string s = "[";
+    for (size_t i = 0; i < n; ++i) {
+        if (i) s += ',';
+        s += "{\"id\":" + std::to_string(i) + ",\"v\":" + std::to_string(i == changed ? 0 : 1) + "}";
+    }
+    return s + "]";
+}
+
+int main() {
+    std::cout << "=== JSON Diff Tests ===\n\n";
+
+    try {
+        auto h = [](const std::string& json) { return hashJson(JsonParser::parse(json)); };
+        report("key order does not change hash", h(R"({"a":1,"b":[1,2]})") == h(R"({"b":[1,2],"a":1})"));
+        report("element order changes hash", h("[1,2]") != h("[2,1]"));
+        report("1 and \"1\" hash apart", h("1") != h("\"1\""));
+        report("[] and {} hash apart", h("[]") != h("{}"));
+        report("-0 and 0 hash alike", h("-0") == h("0"));
+
+        expectDiff("identical modulo key order", R"({"x":{"p":1,"q":2}})", R"({"x":{"q":2,"p":1}})", "");
+        expectDiff("nested change", R"({"a":{"b":[1,{"c":true}]}})", R"({"a":{"b":[1,{"c":false}]}})", "~/a/b/1/c");
+        expectDiff("added and removed keys", R"({"a":1,"b":2})", R"({"b":2,"c":3})", "-/a +/c");
+        expectDiff("type change", R"({"a":[1]})", R"({"a":{"0":1}})", "~/a");
+        expectDiff("insert at array front", "[1,2,3]", "[0,1,2,3]", "+/0");
+        expectDiff("remove from array middle", "[1,2,3,4]", "[1,2,4]", "-/2");
+        expectDiff("pointer escaping", R"({"a/b":{"c~d":1}})", R"({"a/b":{"c~d":2}})", "~/a~1b/c~0d");
+        expectDiff("root scalar", "1", "2", "~");
+
+        // Past the recording threshold subtrees are matched by stored hash
+        JsonSubtreeHashes ha, hb;
+        auto a = JsonParser::parse(bigArray(5000, 5000));
+        auto b = JsonParser::parse(bigArray(5000, 1234));
+        hashJson(a, &ha);
+        hashJson(b, &hb);
+        report("large subtrees are recorded", !ha.empty() && ha.size() < 5000);
+        report("one change in a large array", summarize(diffJson(a, ha, b, hb)) == "~/1234/v");
+    } catch (const std::exception& e) {
+        std::cout << "FAIL (exception: " << e.what() << ")\n";
+    }
+
+    return 0;
+}
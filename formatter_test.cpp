@@ -97,6 +97,23 @@ void run_format_test(const FormatTest& t) {
     }
 }
 
+// Parsed with KeepLexemes, compact output must copy scalars byte for byte
+// and still describe the same document.
+void run_lexeme_test(const std::string& input, const std::string& expected, const std::string& description) {
+    std::cout << std::left << std::setw(42) << ("[" + description + "]")
+              << " → ";
+    try {
+        auto preserved = JsonLexemeParser::parse(input);
+        std::ostringstream oss;
+        printJson(preserved, oss, 0, 2, true, false);
+        bool ok = oss.str() == expected && json_equal(preserved, JsonParser::parse(input));
+        std::cout << (ok ? "PASS" : "FAIL") << "\n";
+        if (!ok) std::cout << "  Formatted: " << oss.str() << "\n";
+    } catch (const std::exception& e) {
+        std::cout << "FAIL (exception: " << e.what() << ")\n";
+    }
+}
+
 int main() {
     std::cout << "=== JSON Formatter Tests ===\n\n";
 
@@ -147,6 +164,14 @@ int main() {
     }
 
     std::cout << "\nRan " << tests.size() << " formatter tests.\n";
+
+    std::cout << "\n=== Lexeme Preservation Tests ===\n\n";
+    run_lexeme_test("[1.50, 1e3, -0.0, 12345678901234567890]", "[1.50,1e3,-0.0,12345678901234567890]",
+                    "numbers kept as written");
+    run_lexeme_test(R"([ "caf\u00e9", "a\/b", "tab\there" ])", R"(["caf\u00e9","a\/b","tab\there"])",
+                    "string escapes kept");
+    run_lexeme_test(R"({"k": [true, null, {"n": 2.0}]})", R"({"k":[true,null,{"n":2.0}]})",
+                    "nested lexemes");
     // In a real version: std::cout << pass_count << " passed\n";
 
     return 0;
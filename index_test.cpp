@@ -0,0 +1,96 @@
+// index_test.cpp
+#include "jsonindex.h"
+#include "jsonformatter.h"
+#include "jsonpointer.h"
+#include <chrono>
+#include <filesystem>
+#include <fstream>
+#include <iomanip>
+#include <iostream>
+#include <sstream>
+#include <string>
+
+void report(const std::string& description, bool ok) {
+    std::cout << std::left << std::setw(38) << ("[" + description + "]")
+              << " → " << (ok ? "PASS" : "FAIL") << '\n';
+}
+
+std::string compact(const std::shared_ptr<JsonValue>& v) {
+    std::ostringstream os;
+    printJson(v, os, 0, 2, true);
+    return os.str();
+}
+
+// The indexed lookup must agree with resolving the pointer in a full parse.
+void expectSame(const std::string& description, const JsonIndex& index,
+                const std::shared_ptr<JsonValue>& dom, const std::string& pointer) {
+    std::string got, want;
+    try { got = compact(index.query(pointer)); } catch (const std::exception& e) { got = e.what(); }
+    try { want = compact(resolveJsonPointer(dom, pointer)); } catch (const std::exception& e) { want = e.what(); }
+    report(description, got == want);
+    if (got != want) std::cout << "  got:  " << got << "\n  want: " << want << '\n';
+}
+
+int main() {
+    std::cout << "=== Index Tests ===\n\n";
+
+    namespace fs = std::filesystem;
+    const std::string dir = (fs::temp_directory_path() / "jsonify_index_test").string();
+    fs::remove_all(dir);
+    fs::create_directories(dir);
+    const std::string file = dir + "/doc.json";
+    const std::string text = R"( {
+        "items": [ {"id": 0, "tags": ["a"]}, {"id": 1, "tags": []}, 7, "s,]" , [[1], {"}": 2}] ],
+        "a/b": {"c~d": true, "long": [1, 2, 3, 4, 5, 6, 7, 8, 9, 10]},
+        "esc\u00e9": null,
+        "dup": 1, "dup": 2,
+        "empty": {},
+        "price": [1.50e0, "caf\u00e9"]
+    } )";
+    std::ofstream(file, std::ios::binary) << text;
+
+    try {
+        // A tiny threshold indexes nearly every container.
+        JsonIndexSummary summary = buildJsonIndex(file, jsonIndexPath(file), 8);
+        report("containers indexed", summary.containers > 4);
+
+        JsonIndex index(file, jsonIndexPath(file));
+        auto dom = JsonParser::parse(text);
+        report("fresh index", index.fresh());
+        expectSame("whole document", index, dom, "");
+        expectSame("array element", index, dom, "/items/1");
+        expectSame("through indexed levels", index, dom, "/items/0/tags/0");
+        expectSame("string with delimiters", index, dom, "/items/3");
+        expectSame("nested arrays", index, dom, "/items/4/1/}");
+        expectSame("escaped pointer tokens", index, dom, "/a~1b/c~0d");
+        expectSame("escaped key", index, dom, "/esc\xc3\xa9");
+        expectSame("last duplicate wins", index, dom, "/dup");
+        expectSame("empty object", index, dom, "/empty");
+        expectSame("missing key", index, dom, "/a~1b/zz");
+        expectSame("index out of range", index, dom, "/items/5");
+        expectSame("path into a scalar", index, dom, "/items/2/x");
+
+        std::string slice;
+        report("source text kept on request", compact(index.query("/price", std::pmr::get_default_resource(), &slice))
+                                                  == R"([1.50e0,"caf\u00e9"])");
+
+        // Only the root is indexed with the default threshold.
+        JsonIndexSummary rootOnly = buildJsonIndex(file, jsonIndexPath(file));
+        JsonIndex coarse(file, jsonIndexPath(file));
+        report("root always indexed", rootOnly.containers == 1);
+        expectSame("unindexed subtree", coarse, dom, "/a~1b/long/9");
+
+        fs::last_write_time(file, fs::last_write_time(file) + std::chrono::seconds(2));
+        report("modified source is stale", !JsonIndex(file, jsonIndexPath(file)).fresh());
+
+        std::ofstream(file, std::ios::binary) << "[1, 2,]";
+        bool threw = false;
+        try { buildJsonIndex(file, jsonIndexPath(file)); } catch (const std::exception&) { threw = true; }
+        report("syntax error while indexing", threw);
+    } catch (const std::exception& e) {
+        std::cout << "FAIL (exception: " << e.what() << ")\n";
+    }
+
+    fs::remove_all(dir);
+    return 0;
+}
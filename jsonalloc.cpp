@@ -0,0 +1,67 @@
+#include "jsonalloc.h"
+#include <atomic>
+#include <cstddef>
+#include <cstdlib>
+#include <new>
+#ifdef _WIN32
+#  include <malloc.h>
+#endif
+
+static bool gCountAllocations = false;
+static std::atomic<uint64_t> gAllocCount{0};
+static std::atomic<uint64_t> gAllocBytes{0};
+
+void setAllocationCounting(bool on) { gCountAllocations = on; }
+uint64_t allocationCount() { return gAllocCount.load(std::memory_order_relaxed); }
+uint64_t allocationBytes() { return gAllocBytes.load(std::memory_order_relaxed); }
+
+static void count(std::size_t n) {
+    if (!gCountAllocations) return;
+    gAllocCount.fetch_add(1, std::memory_order_relaxed);
+    gAllocBytes.fetch_add(n, std::memory_order_relaxed);
+}
+
+// Over-aligned blocks: MSVC has no std::aligned_alloc, and its blocks must be
+// released with _aligned_free rather than free.
+static void* alignedAlloc(std::size_t n, std::size_t a) {
+#ifdef _WIN32
+    return _aligned_malloc(n ? n : 1, a);
+#else
+    return std::aligned_alloc(a, (n + a - 1) / a * a);
+#endif
+}
+
+static void alignedFree(void* p, std::size_t a) noexcept {
+    if (a <= alignof(std::max_align_t)) { std::free(p); return; }   // came from plain new
+#ifdef _WIN32
+    _aligned_free(p);
+#else
+    std::free(p);
+#endif
+}
+
+/* --------------------------------------------------------------- */
+void* operator new(std::size_t n) {
+    count(n);
+    if (void* p = std::malloc(n ? n : 1)) return p;
+    throw std::bad_alloc();
+}
+void* operator new[](std::size_t n) { return operator new(n); }
+void operator delete(void* p) noexcept { std::free(p); }
+void operator delete[](void* p) noexcept { std::free(p); }
+void operator delete(void* p, std::size_t) noexcept { std::free(p); }
+void operator delete[](void* p, std::size_t) noexcept { std::free(p); }
+
+// std::pmr's default resource allocates through the aligned overloads
+void* operator new(std::size_t n, std::align_val_t al) {
+    const std::size_t a = static_cast<std::size_t>(al);
+    if (a <= alignof(std::max_align_t)) return operator new(n);
+    count(n);
+    if (void* p = alignedAlloc(n, a)) return p;
+    throw std::bad_alloc();
+}
+void* operator new[](std::size_t n, std::align_val_t a) { return operator new(n, a); }
+void operator delete(void* p, std::align_val_t a) noexcept { alignedFree(p, static_cast<std::size_t>(a)); }
+void operator delete[](void* p, std::align_val_t a) noexcept { alignedFree(p, static_cast<std::size_t>(a)); }
+void operator delete(void* p, std::size_t, std::align_val_t a) noexcept { alignedFree(p, static_cast<std::size_t>(a)); }
+void operator delete[](void* p, std::size_t, std::align_val_t a) noexcept { alignedFree(p, static_cast<std::size_t>(a)); }
@@ -0,0 +1,16 @@
+#ifndef JSONALLOC_H
+#define JSONALLOC_H
+
+#include <cstdint>
+
+// Counting replacements for the global operator new/delete, shared by the CLI
+// (--stats) and the benchmark. Linking jsonalloc.cpp installs them for the
+// whole program, so it is built into those executables only and is not part
+// of the jsonify_core library. Counting is off until enabled; switch it on before any
+// worker thread starts, so that without it the only cost is a predictable
+// branch.
+void     setAllocationCounting(bool on);
+uint64_t allocationCount();          // global allocations while counting
+uint64_t allocationBytes();          // bytes requested by them
+
+#endif // JSONALLOC_H
@@ -0,0 +1,332 @@
+#include "jsonbinary.h"
+#include <algorithm>
+#include <cstring>
+#include <vector>
+
+#ifdef _WIN32
+#  ifndef NOMINMAX
+#    define NOMINMAX
+#  endif
+#  include <windows.h>
+#else
+#  include <fcntl.h>
+#  include <sys/mman.h>
+#  include <sys/stat.h>
+#  include <unistd.h>
+#endif
+
+namespace {
+
+const char     kMagic[8]   = {'J','S','F','Y','B','I','N','\0'};
+const uint32_t kVersion    = 1;
+const size_t   kHeaderSize = 24;
+
+enum Tag : unsigned char {
+    kNull = 0, kFalse = 1, kTrue = 2, kNumber = 3, kString = 4, kArray = 5, kObject = 6
+};
+
+void putU32(std::string& out, uint32_t v) {
+    for (int i = 0; i < 4; ++i) out += static_cast<char>((v >> (8 * i)) & 0xFF);
+}
+
+void putU64(std::string& out, uint64_t v) {
+    for (int i = 0; i < 8; ++i) out += static_cast<char>((v >> (8 * i)) & 0xFF);
+}
+
+void patchU64(std::string& out, size_t at, uint64_t v) {
+    for (int i = 0; i < 8; ++i) out[at + i] = static_cast<char>((v >> (8 * i)) & 0xFF);
+}
+
+uint32_t checkedCount(size_t n) {
+    if (n > UINT32_MAX) throw std::runtime_error("Container too large for binary format");
+    return static_cast<uint32_t>(n);
+}
+
+void writeString(std::string& out, std::string_view s) {
+    out += static_cast<char>(kString);
+    putU32(out, checkedCount(s.size()));
+    out += s;
+}
+
+void writeNode(std::string& out, const std::shared_ptr<JsonValue>& v) {
+    using Type = JsonValue::Type;
+    if (!v || v->getType() == Type::Null) { out += static_cast<char>(kNull); return; }
+
+    switch (v->getType()) {
+    case Type::Null:
+        break;
+    case Type::Bool:
+        out += static_cast<char>(v->getBool() ? kTrue : kFalse);
+        break;
+    case Type::Number: {
+        double d = v->getNumber();
+        uint64_t bits;
+        std::memcpy(&bits, &d, sizeof bits);
+        out += static_cast<char>(kNumber);
+        putU64(out, bits);
+        break;
+    }
+    case Type::String:
+        writeString(out, v->getString());
+        break;
+    case Type::Array: {
+        const auto& a = v->getArray();
+        out += static_cast<char>(kArray);
+        putU32(out, checkedCount(a.size()));
+        size_t table = out.size();
+        out.append(a.size() * 8, '\0');
+        for (size_t i = 0; i < a.size(); ++i) {
+            patchU64(out, table + i * 8, out.size());
+            writeNode(out, a[i]);
+        }
+        break;
+    }
+    case Type::Object: {
+        const auto& o = v->getObject();
+        std::vector<const JsonObject::value_type*> entries;
+        entries.reserve(o.size());
+        for (const auto& kv : o) entries.push_back(&kv);
+        std::sort(entries.begin(), entries.end(),
+                  [](const auto* a, const auto* b) { return a->first < b->first; });
+
+        out += static_cast<char>(kObject);
+        putU32(out, checkedCount(entries.size()));
+        size_t table = out.size();
+        out.append(entries.size() * 16, '\0');
+        for (size_t i = 0; i < entries.size(); ++i) {
+            patchU64(out, table + i * 16, out.size());
+            writeString(out, entries[i]->first);
+            patchU64(out, table + i * 16 + 8, out.size());
+            writeNode(out, entries[i]->second);
+        }
+        break;
+    }
+    }
+}
+
+} // namespace
+
+/* --------------------------------------------------------------- */
+std::string toJsonBinary(const std::shared_ptr<JsonValue>& root) {
+    std::string out(kMagic, sizeof kMagic);
+    putU32(out, kVersion);
+    putU32(out, 0);
+    putU64(out, kHeaderSize);
+    writeNode(out, root);
+    return out;
+}
+
+void writeJsonBinary(const std::shared_ptr<JsonValue>& root, std::ostream& os) {
+    std::string bin = toJsonBinary(root);
+    os.write(bin.data(), static_cast<std::streamsize>(bin.size()));
+}
+
+/* --------------------------------------------------------------- */
+JsonBinaryView::JsonBinaryView(const char* data, size_t size)
+    : data_(data), size_(size), root_(0) {
+    if (size_ < kHeaderSize || std::memcmp(data_, kMagic, sizeof kMagic) != 0)
+        throw std::runtime_error("Not a jsonify binary document");
+    if (readU32(8) != kVersion)
+        throw std::runtime_error("Unsupported binary document version");
+    root_ = readU64(16);
+    bytes(root_, 1);
+}
+
+JsonBinaryView::Node JsonBinaryView::root() const { return Node(this, root_); }
+
+const unsigned char* JsonBinaryView::bytes(uint64_t off, uint64_t len) const {
+    if (off > size_ || len > size_ - off)
+        throw std::runtime_error("Corrupt binary document (offset out of range)");
+    return reinterpret_cast<const unsigned char*>(data_) + off;
+}
+
+uint32_t JsonBinaryView::readU32(uint64_t off) const {
+    const unsigned char* b = bytes(off, 4);
+    uint32_t v = 0;
+    for (int i = 3; i >= 0; --i) v = (v << 8) | b[i];
+    return v;
+}
+
+uint64_t JsonBinaryView::readU64(uint64_t off) const {
+    const unsigned char* b = bytes(off, 8);
+    uint64_t v = 0;
+    for (int i = 7; i >= 0; --i) v = (v << 8) | b[i];
+    return v;
+}
+
+/* --------------------------------------------------------------- */
+JsonValue::Type JsonBinaryView::Node::getType() const {
+    switch (*doc_->bytes(off_, 1)) {
+        case kNull:   return JsonValue::Type::Null;
+        case kFalse:
+        case kTrue:   return JsonValue::Type::Bool;
+        case kNumber: return JsonValue::Type::Number;
+        case kString: return JsonValue::Type::String;
+        case kArray:  return JsonValue::Type::Array;
+        case kObject: return JsonValue::Type::Object;
+    }
+    throw std::runtime_error("Corrupt binary document (unknown tag)");
+}
+
+bool JsonBinaryView::Node::getBool() const {
+    unsigned char tag = *doc_->bytes(off_, 1);
+    if (tag == kTrue)  return true;
+    if (tag == kFalse) return false;
+    throw std::runtime_error("Cannot retrieve boolean value, types mismatch");
+}
+
+double JsonBinaryView::Node::getNumber() const {
+    if (*doc_->bytes(off_, 1) != kNumber)
+        throw std::runtime_error("Cannot retrieve number value, types mismatch");
+    uint64_t bits = doc_->readU64(off_ + 1);
+    double d;
+    std::memcpy(&d, &bits, sizeof d);
+    return d;
+}
+
+std::string_view JsonBinaryView::Node::getString() const {
+    if (*doc_->bytes(off_, 1) != kString)
+        throw std::runtime_error("Cannot retrieve string value, types mismatch");
+    uint32_t len = doc_->readU32(off_ + 1);
+    return {reinterpret_cast<const char*>(doc_->bytes(off_ + 5, len)), len};
+}
+
+size_t JsonBinaryView::Node::size() const {
+    unsigned char tag = *doc_->bytes(off_, 1);
+    if (tag != kArray && tag != kObject)
+        throw std::runtime_error("Cannot retrieve size, not a container");
+    return doc_->readU32(off_ + 1);
+}
+
+JsonBinaryView::Node JsonBinaryView::Node::at(size_t i) const {
+    if (*doc_->bytes(off_, 1) != kArray)
+        throw std::runtime_error("Cannot retrieve array value, types mismatch");
+    if (i >= doc_->readU32(off_ + 1)) throw std::out_of_range("Array index out of range");
+    return Node(doc_, doc_->readU64(off_ + 5 + i * 8));
+}
+
+std::string_view JsonBinaryView::Node::keyAt(size_t i) const {
+    if (*doc_->bytes(off_, 1) != kObject)
+        throw std::runtime_error("Cannot retrieve object value, types mismatch");
+    if (i >= doc_->readU32(off_ + 1)) throw std::out_of_range("Object index out of range");
+    return Node(doc_, doc_->readU64(off_ + 5 + i * 16)).getString();
+}
+
+JsonBinaryView::Node JsonBinaryView::Node::valueAt(size_t i) const {
+    if (*doc_->bytes(off_, 1) != kObject)
+        throw std::runtime_error("Cannot retrieve object value, types mismatch");
+    if (i >= doc_->readU32(off_ + 1)) throw std::out_of_range("Object index out of range");
+    return Node(doc_, doc_->readU64(off_ + 5 + i * 16 + 8));
+}
+
+std::optional<JsonBinaryView::Node> JsonBinaryView::Node::find(std::string_view key) const {
+    size_t lo = 0, hi = size();
+    while (lo < hi) {
+        size_t mid = lo + (hi - lo) / 2;
+        int cmp = keyAt(mid).compare(key);
+        if (cmp == 0) return valueAt(mid);
+        if (cmp < 0) lo = mid + 1;
+        else         hi = mid;
+    }
+    return std::nullopt;
+}
+
+// The writer emits every child after its parent, so offsets only move
+// forward along a path; anything else would loop or share subtrees.
+JsonBinaryView::Node JsonBinaryView::Node::child(Node n) const {
+    if (n.off_ <= off_) throw std::runtime_error("Corrupt binary document: child offset does not follow its parent");
+    return n;
+}
+
+std::shared_ptr<JsonValue> JsonBinaryView::Node::toValue(std::pmr::memory_resource* mr) const {
+    return toValue(mr, 0);
+}
+
+std::shared_ptr<JsonValue> JsonBinaryView::Node::toValue(std::pmr::memory_resource* mr, unsigned depth) const {
+    switch (getType()) {
+    case JsonValue::Type::Null:   return makeJsonValue(mr);
+    case JsonValue::Type::Bool:   return makeJsonValue(mr, getBool());
+    case JsonValue::Type::Number: return makeJsonValue(mr, getNumber());
+    case JsonValue::Type::String: return makeJsonValue(mr, JsonString(getString(), mr));
+    case JsonValue::Type::Array:
+    case JsonValue::Type::Object:
+        break;
+    }
+    if (depth >= kMaxDepth) throw std::runtime_error("Corrupt binary document: nesting too deep");
+    size_t n = size();
+    const bool isArray = getType() == JsonValue::Type::Array;
+    doc_->bytes(off_ + 5, uint64_t(n) * (isArray ? 8 : 16)); // whole offset table in range before reserving
+    if (isArray) {
+        JsonArray arr(mr);
+        arr.reserve(n);
+        for (size_t i = 0; i < n; ++i) arr.push_back(child(at(i)).toValue(mr, depth + 1));
+        return makeJsonValue(mr, std::move(arr));
+    }
+    JsonObject obj(mr);
+    obj.reserve(n);
+    for (size_t i = 0; i < n; ++i)
+        obj.emplace(JsonString(keyAt(i), mr), child(valueAt(i)).toValue(mr, depth + 1));
+    return makeJsonValue(mr, std::move(obj));
+}
+
+/* --------------------------------------------------------------- */
+#ifdef _WIN32
+JsonMappedFile::JsonMappedFile(const std::string& filename) {
+    HANDLE file = CreateFileA(filename.c_str(), GENERIC_READ, FILE_SHARE_READ, nullptr,
+                              OPEN_EXISTING, FILE_ATTRIBUTE_NORMAL, nullptr);
+    if (file == INVALID_HANDLE_VALUE) throw std::runtime_error("Cannot open file: " + filename);
+    LARGE_INTEGER len;
+    if (!GetFileSizeEx(file, &len)) {
+        CloseHandle(file);
+        throw std::runtime_error("Cannot open file: " + filename);
+    }
+    if (len.QuadPart == 0) {   // empty files cannot be mapped
+        CloseHandle(file);
+        return;
+    }
+    HANDLE mapping = CreateFileMappingA(file, nullptr, PAGE_READONLY, 0, 0, nullptr);
+    CloseHandle(file);
+    if (!mapping) throw std::runtime_error("Cannot map file: " + filename);
+    data_ = static_cast<const char*>(MapViewOfFile(mapping, FILE_MAP_READ, 0, 0, 0));
+    if (!data_) {
+        CloseHandle(mapping);
+        throw std::runtime_error("Cannot map file: " + filename);
+    }
+    handle_ = mapping;
+    size_ = static_cast<size_t>(len.QuadPart);
+}
+
+JsonMappedFile::~JsonMappedFile() {
+    if (!data_) return;
+    UnmapViewOfFile(data_);
+    CloseHandle(static_cast<HANDLE>(handle_));
+}
+#else
+JsonMappedFile::JsonMappedFile(const std::string& filename) {
+    int fd = ::open(filename.c_str(), O_RDONLY);
+    if (fd < 0) throw std::runtime_error("Cannot open file: " + filename);
+    struct stat st;
+    if (::fstat(fd, &st) != 0) {
+        ::close(fd);
+        throw std::runtime_error("Cannot open file: " + filename);
+    }
+    if (st.st_size == 0) {   // empty files cannot be mapped
+        ::close(fd);
+        return;
+    }
+    size_ = static_cast<size_t>(st.st_size);
+    void* p = ::mmap(nullptr, size_, PROT_READ, MAP_PRIVATE, fd, 0);
+    ::close(fd);
+    if (p == MAP_FAILED) throw std::runtime_error("Cannot map file: " + filename);
+    data_ = static_cast<const char*>(p);
+}
+
+JsonMappedFile::~JsonMappedFile() {
+    if (data_) ::munmap(const_cast<char*>(data_), size_);
+}
+#endif
+
+JsonBinaryFile::JsonBinaryFile(const std::string& filename) : file_(filename) {
+    if (file_.size() == 0) throw std::runtime_error("Not a jsonify binary document: " + filename);
+    view_ = std::make_unique<JsonBinaryView>(file_.data(), file_.size());
+}
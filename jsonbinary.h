@@ -0,0 +1,111 @@
+#ifndef JSONBINARY_H
+#define JSONBINARY_H
+
+#include <cstdint>
+#include <memory>
+#include <memory_resource>
+#include <optional>
+#include <ostream>
+#include <string>
+#include <string_view>
+#include "jsonparser.h"
+
+// Native binary document format ("JSFYBIN").
+//
+// Layout (all integers little-endian):
+//   header : "JSFYBIN\0" | u32 version | u32 reserved | u64 root offset
+//   null/false/true : u8 tag
+//   number : u8 tag | f64
+//   string : u8 tag | u32 length | bytes
+//   array  : u8 tag | u32 count | count x u64 element offset
+//   object : u8 tag | u32 count | count x (u64 key offset, u64 value offset)
+//            keys are string nodes, sorted bytewise so lookups can bisect
+//
+// Offsets are absolute from the start of the file, so a mapped file can be
+// walked in place through JsonBinaryView without building a JsonValue tree.
+
+void writeJsonBinary(const std::shared_ptr<JsonValue>& root, std::ostream& os);
+std::string toJsonBinary(const std::shared_ptr<JsonValue>& root);
+
+class JsonBinaryView {
+public:
+    class Node {
+    public:
+        JsonValue::Type  getType()   const;
+        bool             getBool()   const;
+        double           getNumber() const;
+        std::string_view getString() const;
+
+        size_t size() const;                       // array/object element count
+        Node   at(size_t i) const;                 // array element
+        std::string_view keyAt(size_t i) const;    // object key
+        Node   valueAt(size_t i) const;            // object value
+        std::optional<Node> find(std::string_view key) const;
+
+        // Deserializes this subtree, allocating from `mr` like the parser.
+        // Throws std::runtime_error on a corrupt document: a child that does
+        // not lie after its parent, or nesting deeper than kMaxDepth.
+        std::shared_ptr<JsonValue> toValue(std::pmr::memory_resource* mr = std::pmr::get_default_resource()) const;
+
+        static constexpr unsigned kMaxDepth = 4096;
+
+    private:
+        friend class JsonBinaryView;
+        std::shared_ptr<JsonValue> toValue(std::pmr::memory_resource* mr, unsigned depth) const;
+        Node child(Node n) const;
+        Node(const JsonBinaryView* doc, uint64_t off) : doc_(doc), off_(off) {}
+        const JsonBinaryView* doc_;
+        uint64_t off_;
+    };
+
+    // The view does not own the bytes; they must outlive it.
+    JsonBinaryView(const char* data, size_t size);
+
+    Node root() const;
+
+private:
+    friend class Node;
+    const unsigned char* bytes(uint64_t off, uint64_t len) const;
+    uint32_t readU32(uint64_t off) const;
+    uint64_t readU64(uint64_t off) const;
+
+    const char* data_;
+    size_t      size_;
+    uint64_t    root_;
+};
+
+// Read-only memory mapping of a whole file. An empty file maps to
+// data() == nullptr, size() == 0.
+class JsonMappedFile {
+public:
+    explicit JsonMappedFile(const std::string& filename);
+    ~JsonMappedFile();
+    JsonMappedFile(const JsonMappedFile&) = delete;
+    JsonMappedFile& operator=(const JsonMappedFile&) = delete;
+
+    const char* data() const { return data_; }
+    size_t      size() const { return size_; }
+
+private:
+    const char* data_ = nullptr;
+    size_t      size_ = 0;
+#ifdef _WIN32
+    void*       handle_ = nullptr;   // file mapping handle
+#endif
+};
+
+// Read-only memory mapping of a binary document.
+class JsonBinaryFile {
+public:
+    explicit JsonBinaryFile(const std::string& filename);
+    JsonBinaryFile(const JsonBinaryFile&) = delete;
+    JsonBinaryFile& operator=(const JsonBinaryFile&) = delete;
+
+    const JsonBinaryView& view() const { return *view_; }
+
+private:
+    JsonMappedFile file_;
+    std::unique_ptr<JsonBinaryView> view_;
+};
+
+#endif
@@ -0,0 +1,165 @@
+#include "jsonbind.h"
+#include <cstring>
+#include <fstream>
+#include "jsonlex.h"
+#include "jsonparser.h"
+
+using json_lex::hasClass;
+
+JsonReader::JsonReader(std::string_view text)
+    : begin_(text.data()), p_(text.data()), end_(text.data() + text.size()) {}
+
+/* --------------------------------------------------------------- */
+// Positions are only needed on failure, so they are recomputed from the
+// start of the text here instead of being tracked while reading.
+void JsonReader::fail(const std::string& msg) const {
+    size_t line = 1;
+    const char* lineStart = begin_;
+    for (const char* q = begin_; q != p_; ++q) {
+        if (*q == '\n') { ++line; lineStart = q + 1; }
+    }
+    size_t col = static_cast<size_t>(p_ - lineStart) + 1;
+    throw std::runtime_error(msg + " (line " + std::to_string(line)
+                             + ", col " + std::to_string(col) + ")");
+}
+
+void JsonReader::skipWhitespace() {
+    while (p_ != end_ && hasClass(*p_, json_lex::kSpace)) ++p_;
+}
+
+char JsonReader::peek() {
+    skipWhitespace();
+    return p_ == end_ ? '\0' : *p_;
+}
+
+void JsonReader::expect(char c) {
+    if (peek() != c) {
+        if (p_ == end_) fail("Unexpected end of input");
+        fail(std::string("Expected '") + c + "'");
+    }
+    ++p_;
+}
+
+bool JsonReader::consume(char c) {
+    if (peek() != c) return false;
+    ++p_;
+    return true;
+}
+
+void JsonReader::finish() {
+    if (peek() != '\0') fail("Unexpected trailing content");
+}
+
+/* --------------------------------------------------------------- */
+bool JsonReader::readBool() {
+    char c = peek();
+    if (c == 't' && end_ - p_ >= 4 && std::memcmp(p_, "true", 4) == 0)  { p_ += 4; return true; }
+    if (c == 'f' && end_ - p_ >= 5 && std::memcmp(p_, "false", 5) == 0) { p_ += 5; return false; }
+    fail("Expected boolean");
+}
+
+void JsonReader::readNull() {
+    if (peek() != 'n' || end_ - p_ < 4 || std::memcmp(p_, "null", 4) != 0) fail("Expected null");
+    p_ += 4;
+}
+
+std::string_view JsonReader::readNumberToken() {
+    char c = peek();
+    if (c != '-' && !hasClass(c, json_lex::kDigit)) fail("Expected number");
+    const char* start = p_;
+    bool integer;
+    if (const char* err = json_lex::strictNumber(p_, end_, integer)) fail(err);
+    return std::string_view(start, static_cast<size_t>(p_ - start));
+}
+
+double JsonReader::readNumber() {
+    std::string_view tok = readNumberToken();
+    double d;
+    json_lex::toDouble(tok.data(), tok.data() + tok.size(), d);   // already validated
+    return d;
+}
+
+/* --------------------------------------------------------------- */
+void JsonReader::readString(std::string& out) {
+    if (peek() != '"') fail("Expected string");
+    const char* start = p_++;
+    out.clear();
+    if (const char* err = json_lex::stringBody<true>(p_, end_, out)) {
+        if (err == json_lex::kUnterminatedString) p_ = start;
+        fail(err);
+    }
+}
+
+std::string_view JsonReader::readKey(std::string& scratch) {
+    if (peek() != '"') fail("Expected '\"' for object key");
+    const char* q = p_ + 1;
+    while (q != end_ && *q != '"' && *q != '\\' && static_cast<unsigned char>(*q) >= 0x20) ++q;
+    if (q != end_ && *q == '"') {
+        std::string_view key(p_ + 1, static_cast<size_t>(q - p_ - 1));
+        p_ = q + 1;
+        return key;
+    }
+    readString(scratch);
+    return scratch;
+}
+
+/* --------------------------------------------------------------- */
+void JsonReader::skipString() {
+    const char* start = p_++;
+    while (p_ != end_) {
+        char c = *p_++;
+        if (c == '"') return;
+        if (c == '\\') {
+            if (p_ == end_) break;
+            ++p_;
+        } else if (static_cast<unsigned char>(c) < 0x20) {
+            --p_;
+            fail("Unescaped control character in string");
+        }
+    }
+    p_ = start;
+    fail("Unterminated string");
+}
+
+std::string_view JsonReader::skipValue() {
+    peek();
+    const char* start = p_;
+    skipValueAt(0);
+    return std::string_view(start, static_cast<size_t>(p_ - start));
+}
+
+void JsonReader::skipValueAt(unsigned depth) {
+    char c = peek();
+    if ((c == '{' || c == '[') && ++depth > JsonParser::kMaxDepth) fail("Nesting too deep");
+    switch (c) {
+    case '{':
+        ++p_;
+        if (consume('}')) return;
+        do {
+            if (peek() != '"') fail("Expected '\"' for object key");
+            skipString();
+            expect(':');
+            skipValueAt(depth);
+        } while (consume(','));
+        expect('}');
+        return;
+    case '[':
+        ++p_;
+        if (consume(']')) return;
+        do skipValueAt(depth); while (consume(','));
+        expect(']');
+        return;
+    case '"': skipString(); return;
+    case 't': case 'f': readBool(); return;
+    case 'n': readNull(); return;
+    case '\0': fail("Unexpected end of input");
+    default: readNumberToken(); return;
+    }
+}
+
+/* --------------------------------------------------------------- */
+std::string readJsonFile(const std::string& filename) {
+    std::ifstream f(filename, std::ios::binary);
+    if (!f) throw std::runtime_error("Cannot open " + filename);
+    return std::string(std::istreambuf_iterator<char>(f), std::istreambuf_iterator<char>());
+}
@@ -0,0 +1,339 @@
+#ifndef JSONBIND_H
+#define JSONBIND_H
+
+#include <charconv>
+#include <cstddef>
+#include <limits>
+#include <map>
+#include <optional>
+#include <ostream>
+#include <sstream>
+#include <stdexcept>
+#include <string>
+#include <string_view>
+#include <tuple>
+#include <type_traits>
+#include <unordered_map>
+#include <utility>
+#include <vector>
+#include "jsonformatter.h"
+
+// Typed binding: parse JSON straight into C++ types and write them back,
+// without building a JsonValue tree in between.
+//
+// Supported: bool, integers, floating point, std::string, std::vector<T>,
+// std::map / std::unordered_map with std::string keys, std::optional<T>
+// (null or absent -> nullopt) and any struct that has a JsonBinding:
+//
+//   struct Server { std::string host; int port; std::optional<double> timeout; };
+//
+//   template <> struct JsonBinding<Server> {
+//       static constexpr auto fields = std::make_tuple(
+//           jsonField("host", &Server::host),
+//           jsonField("port", &Server::port),
+//           jsonField("timeout", &Server::timeout));
+//   };
+//
+//   Server s = fromJson<Server>(text);
+//   writeJson(s, std::cout);
+//
+// Each key is compared with the field names in field-list order (the
+// comparisons are unrolled at compile time, no lookup table is built);
+// unknown keys are skipped, a missing field is an error unless it is an
+// std::optional, which is then reset even when reading into an object that
+// already held a value. Errors are std::runtime_error with the usual
+// "(line L, col C)" suffix.
+
+template <class T, class M>
+struct JsonField {
+    const char* name;
+    M T::*      member;
+};
+
+template <class T, class M>
+constexpr JsonField<T, M> jsonField(const char* name, M T::* member) {
+    return {name, member};
+}
+
+// Specialise with a `static constexpr auto fields` tuple of jsonField()s.
+template <class T>
+struct JsonBinding;
+
+// Pull tokenizer over JSON text for the binding layer. Tokens are validated
+// and decoded on demand, with the parser's lexing (jsonlex.h); nothing is
+// materialised beyond the value read.
+class JsonReader {
+public:
+    explicit JsonReader(std::string_view text);
+
+    char peek();                  // next significant character, '\0' at the end
+    void expect(char c);
+    bool consume(char c);         // skip `c` if it is the next significant character
+    void finish();                // only whitespace may remain
+
+    bool   readBool();
+    void   readNull();
+    double readNumber();
+    std::string_view readNumberToken();    // validated number lexeme
+    void   readString(std::string& out);
+    // Returns a view into the source when the key has no escapes, otherwise
+    // decodes into `scratch` and returns a view of it.
+    std::string_view readKey(std::string& scratch);
+    std::string_view skipValue();          // returns the skipped value's text
+    size_t offset() const { return static_cast<size_t>(p_ - begin_); }
+
+    [[noreturn]] void fail(const std::string& msg) const;
+
+private:
+    void skipWhitespace();
+    void skipString();
+    void skipValueAt(unsigned depth);
+
+    const char* begin_;
+    const char* p_;
+    const char* end_;
+};
+
+namespace json_detail {
+
+template <class T, class = void> struct isBound : std::false_type {};
+template <class T> struct isBound<T, std::void_t<decltype(JsonBinding<T>::fields)>> : std::true_type {};
+
+template <class T> struct isOptional : std::false_type {};
+template <class T> struct isOptional<std::optional<T>> : std::true_type {};
+
+template <class T> struct isVector : std::false_type {};
+template <class T, class A> struct isVector<std::vector<T, A>> : std::true_type {};
+
+template <class T> struct isStringMap : std::false_type {};
+template <class V, class C, class A>
+struct isStringMap<std::map<std::string, V, C, A>> : std::true_type {};
+template <class V, class H, class E, class A>
+struct isStringMap<std::unordered_map<std::string, V, H, E, A>> : std::true_type {};
+
+template <class T> struct dependentFalse : std::false_type {};
+
+template <class T>
+T readInteger(JsonReader& in) {
+    std::string_view tok = in.readNumberToken();
+    if constexpr (std::is_unsigned_v<T>) {
+        if (tok[0] == '-') in.fail("Integer out of range");
+    }
+    using Wide = std::conditional_t<std::is_signed_v<T>, long long, unsigned long long>;
+    Wide v = 0;
+    auto res = std::from_chars(tok.data(), tok.data() + tok.size(), v);
+    if (res.ptr != tok.data() + tok.size()) {
+        if (res.ec == std::errc::result_out_of_range) in.fail("Integer out of range");
+        in.fail("Expected integer");
+    }
+    if (res.ec != std::errc() || v < static_cast<Wide>(std::numeric_limits<T>::min())
+                              || v > static_cast<Wide>(std::numeric_limits<T>::max()))
+        in.fail("Integer out of range");
+    return static_cast<T>(v);
+}
+
+template <class T> void read(JsonReader& in, T& out);
+
+template <class T, class Tuple, size_t... I>
+bool readField(JsonReader& in, T& out, std::string_view key, const Tuple& fields,
+               bool* seen, std::index_sequence<I...>) {
+    return ((key == std::get<I>(fields).name
+                 ? (read(in, out.*(std::get<I>(fields).member)), seen[I] = true, true)
+                 : false) || ...);
+}
+
+// Fields the input did not name: an error, or nullopt for an std::optional
+// (which may still hold a value when reading into an existing object).
+template <class T, class Tuple, size_t... I>
+void finishFields(JsonReader& in, T& out, const Tuple& fields, const bool* seen,
+                  std::index_sequence<I...>) {
+    auto finish = [&](size_t i, const char* name, auto& member) {
+        if (seen[i]) return;
+        if constexpr (isOptional<std::remove_reference_t<decltype(member)>>::value)
+            member.reset();
+        else
+            in.fail(std::string("Missing field \"") + name + "\"");
+    };
+    (finish(I, std::get<I>(fields).name, out.*(std::get<I>(fields).member)), ...);
+}
+
+template <class T>
+void readObject(JsonReader& in, T& out) {
+    constexpr const auto& fields = JsonBinding<T>::fields;
+    constexpr size_t n = std::tuple_size_v<std::remove_cv_t<std::remove_reference_t<decltype(fields)>>>;
+    bool seen[n + 1] = {};
+    std::string scratch;
+
+    in.expect('{');
+    if (!in.consume('}')) {
+        do {
+            std::string_view key = in.readKey(scratch);
+            in.expect(':');
+            if (!readField(in, out, key, fields, seen, std::make_index_sequence<n>{}))
+                in.skipValue();
+        } while (in.consume(','));
+        in.expect('}');
+    }
+    finishFields(in, out, fields, seen, std::make_index_sequence<n>{});
+}
+
+template <class T>
+void read(JsonReader& in, T& out) {
+    if constexpr (std::is_same_v<T, bool>) {
+        out = in.readBool();
+    } else if constexpr (std::is_integral_v<T>) {
+        out = readInteger<T>(in);
+    } else if constexpr (std::is_floating_point_v<T>) {
+        out = static_cast<T>(in.readNumber());
+    } else if constexpr (std::is_same_v<T, std::string>) {
+        in.readString(out);
+    } else if constexpr (isOptional<T>::value) {
+        if (in.peek() == 'n') { in.readNull(); out.reset(); }
+        else read(in, out.emplace());
+    } else if constexpr (isVector<T>::value) {
+        out.clear();
+        in.expect('[');
+        if (in.consume(']')) return;
+        // std::vector<bool> hands out proxies, not references
+        if constexpr (std::is_same_v<typename T::value_type, bool>)
+            do out.push_back(in.readBool()); while (in.consume(','));
+        else
+            do read(in, out.emplace_back()); while (in.consume(','));
+        in.expect(']');
+    } else if constexpr (isStringMap<T>::value) {
+        out.clear();
+        std::string key;
+        in.expect('{');
+        if (in.consume('}')) return;
+        do {
+            in.readString(key);
+            in.expect(':');
+            read(in, out[key]);
+        } while (in.consume(','));
+        in.expect('}');
+    } else if constexpr (isBound<T>::value) {
+        readObject(in, out);
+    } else {
+        static_assert(dependentFalse<T>::value, "type has no JsonBinding");
+    }
+}
+
+// Pretty layout matches printJson(): one member per line, `indent` being
+// the enclosing container's indentation.
+struct Writer {
+    std::ostream& os;
+    int  indentStep;
+    bool compact;
+
+    void open(char c) { os << c; }
+    void item(bool first, int indent, const std::string_view* key) {
+        if (!first) os << ',';
+        if (!compact) { os << '\n'; printIndent(os, indent + indentStep); }
+        if (key) {
+            printJsonString(os, *key);
+            os << ':';
+            if (!compact) os << ' ';
+        }
+    }
+    void close(char c, bool empty, int indent) {
+        if (!compact && !empty) { os << '\n'; printIndent(os, indent); }
+        os << c;
+    }
+};
+
+template <class T> void write(Writer& w, const T& v, int indent);
+
+template <class T, class Tuple, size_t... I>
+void writeFields(Writer& w, const T& v, int indent, const Tuple& fields, std::index_sequence<I...>) {
+    auto one = [&](bool first, const char* name, const auto& member) {
+        std::string_view key(name);
+        w.item(first, indent, &key);
+        write(w, member, indent + w.indentStep);
+    };
+    (one(I == 0, std::get<I>(fields).name, v.*(std::get<I>(fields).member)), ...);
+}
+
+template <class T>
+void write(Writer& w, const T& v, int indent) {
+    if constexpr (std::is_same_v<T, bool>) {
+        w.os << (v ? "true" : "false");
+    } else if constexpr (std::is_integral_v<T>) {
+        // widened so that int8_t/uint8_t are not printed as characters
+        if constexpr (std::is_signed_v<T>) w.os << static_cast<long long>(v);
+        else                               w.os << static_cast<unsigned long long>(v);
+    } else if constexpr (std::is_floating_point_v<T>) {
+        printJsonNumber(w.os, static_cast<double>(v));
+    } else if constexpr (std::is_same_v<T, std::string>) {
+        printJsonString(w.os, v);
+    } else if constexpr (isOptional<T>::value) {
+        if (v) write(w, *v, indent);
+        else   w.os << "null";
+    } else if constexpr (isVector<T>::value) {
+        w.open('[');
+        for (size_t i = 0; i < v.size(); ++i) {
+            w.item(i == 0, indent, nullptr);
+            write(w, v[i], indent + w.indentStep);
+        }
+        w.close(']', v.empty(), indent);
+    } else if constexpr (isStringMap<T>::value) {
+        w.open('{');
+        bool first = true;
+        for (const auto& kv : v) {
+            std::string_view key(kv.first);
+            w.item(first, indent, &key);
+            write(w, kv.second, indent + w.indentStep);
+            first = false;
+        }
+        w.close('}', v.empty(), indent);
+    } else if constexpr (isBound<T>::value) {
+        constexpr const auto& fields = JsonBinding<T>::fields;
+        constexpr size_t n = std::tuple_size_v<std::remove_cv_t<std::remove_reference_t<decltype(fields)>>>;
+        w.open('{');
+        writeFields(w, v, indent, fields, std::make_index_sequence<n>{});
+        w.close('}', n == 0, indent);
+    } else {
+        static_assert(dependentFalse<T>::value, "type has no JsonBinding");
+    }
+}
+
+} // namespace json_detail
+
+// Parse `text` into `out`. The whole input must be a single JSON value.
+template <class T>
+void fromJson(std::string_view text, T& out) {
+    JsonReader in(text);
+    json_detail::read(in, out);
+    in.finish();
+}
+
+template <class T>
+T fromJson(std::string_view text) {
+    T out{};
+    fromJson(text, out);
+    return out;
+}
+
+std::string readJsonFile(const std::string& filename);
+
+template <class T>
+T loadJson(const std::string& filename) {
+    return fromJson<T>(readJsonFile(filename));
+}
+
+// Serialise with printJson()'s layout, escaping and number formatting.
+// Struct members are written in field-list order.
+template <class T>
+void writeJson(const T& value, std::ostream& os, int indent = 0, int indentStep = 2,
+               bool compact = false) {
+    json_detail::Writer w{os, indentStep, compact};
+    json_detail::write(w, value, indent);
+}
+
+template <class T>
+std::string toJson(const T& value, bool compact = true) {
+    std::ostringstream os;
+    writeJson(value, os, 0, 2, compact);
+    return os.str();
+}
+
+#endif // JSONBIND_H
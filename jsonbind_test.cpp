@@ -0,0 +1,124 @@
+// jsonbind_test.cpp
+#include "jsonbind.h"
+#include "jsonformatter.h"
+#include <cstdint>
+#include <iomanip>
+#include <iostream>
+#include <map>
+#include <optional>
+#include <sstream>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+struct Endpoint {
+    std::string host;
+    uint16_t port = 0;
+};
+
+struct Config {
+    std::string name;
+    bool enabled = false;
+    double ratio = 0;
+    std::vector<Endpoint> endpoints;
+    std::map<std::string, int> limits;
+    std::optional<std::string> comment;
+    std::optional<int> retries;
+};
+
+template <> struct JsonBinding<Endpoint> {
+    static constexpr auto fields = std::make_tuple(
+        jsonField("host", &Endpoint::host),
+        jsonField("port", &Endpoint::port));
+};
+
+template <> struct JsonBinding<Config> {
+    static constexpr auto fields = std::make_tuple(
+        jsonField("name", &Config::name),
+        jsonField("enabled", &Config::enabled),
+        jsonField("ratio", &Config::ratio),
+        jsonField("endpoints", &Config::endpoints),
+        jsonField("limits", &Config::limits),
+        jsonField("comment", &Config::comment),
+        jsonField("retries", &Config::retries));
+};
+
+void report(const std::string& description, bool ok) {
+    std::cout << std::left << std::setw(38) << ("[" + description + "]")
+              << " → " << (ok ? "PASS" : "FAIL") << '\n';
+}
+
+template <class T>
+void expectError(const std::string& description, const std::string& json, const std::string& fragment) {
+    std::string what;
+    try {
+        fromJson<T>(json);
+    } catch (const std::exception& e) {
+        what = e.what();
+    }
+    report(description, what.find(fragment) != std::string::npos);
+    if (what.find(fragment) == std::string::npos) std::cout << "  (got: " << what << ")\n";
+}
+
+int main() {
+    std::cout << "=== JSON Binding Tests ===\n\n";
+
+    const std::string text = R"({
+        "name": "edge\n\"proxy\" é",
+        "unknown": {"nested": [1, {"x": null}], "s": "}"},
+        "enabled": true,
+        "ratio": 0.25,
+        "endpoints": [{"host": "a", "port": 80}, {"port": 443, "host": "b"}],
+        "limits": {"cpu": 4, "mem": -1},
+        "comment": null
+    })";
+
+    try {
+        Config c = fromJson<Config>(text);
+        report("scalars and escapes", c.name == "edge\n\"proxy\" \xc3\xa9" && c.enabled && c.ratio == 0.25);
+        report("vector of structs", c.endpoints.size() == 2 && c.endpoints[1].host == "b"
+                                    && c.endpoints[1].port == 443);
+        report("string map", c.limits.size() == 2 && c.limits["mem"] == -1);
+        report("null and absent optionals", !c.comment && !c.retries);
+
+        Config reused;
+        reused.comment = "stale";
+        reused.retries = 3;
+        fromJson(R"({"name": "n", "enabled": false, "ratio": 1, "endpoints": [], "limits": {},
+                     "retries": 5})", reused);
+        report("absent optional reset on reuse", !reused.comment && reused.retries == 5);
+
+        // Serialised output reads back to the same values
+        std::string compact = toJson(c);
+        Config back = fromJson<Config>(compact);
+        report("round trip", toJson(back) == compact && back.endpoints[0].port == 80);
+        report("declaration order, compact",
+               compact.rfind(R"({"name":"edge\n\"proxy\" )", 0) == 0
+               && compact.find(R"("comment":null,"retries":null})") != std::string::npos);
+
+        // Pretty layout matches printJson() on the equivalent DOM
+        std::ostringstream typed, dom;
+        std::vector<std::unordered_map<std::string, std::vector<double>>> nested{{{"k", {1.5, 2}}}};
+        writeJson(nested, typed);
+        printJson(JsonParser::parse(R"([{"k": [1.5, 2]}])"), dom);
+        report("pretty layout matches printJson", typed.str() == dom.str());
+
+        auto flags = fromJson<std::vector<bool>>("[true, false, true]");
+        report("vector of bool", flags == std::vector<bool>{true, false, true}
+                                 && toJson(flags) == "[true,false,true]");
+    } catch (const std::exception& e) {
+        std::cout << "FAIL (exception: " << e.what() << ")\n";
+    }
+
+    expectError<Config>("missing required field", R"({"name": "x"})", "Missing field \"enabled\"");
+    expectError<Endpoint>("type mismatch", R"({"host": 1, "port": 2})", "Expected string (line 1, col 10)");
+    expectError<Endpoint>("integer out of range", R"({"host": "h", "port": 70000})", "Integer out of range");
+    expectError<Endpoint>("fraction for integer", R"({"host": "h", "port": 1.5})", "Expected integer");
+    expectError<std::vector<int>>("trailing comma", "[1,]", "Expected number");
+    expectError<std::vector<int>>("trailing content", "[1] x", "Unexpected trailing content");
+    expectError<std::string>("unterminated string", R"(  "abc)", "Unterminated string (line 1, col 3)");
+    expectError<std::string>("bad escape", R"("a\q")", "Invalid escape sequence (line 1, col 4)");
+    expectError<Endpoint>("bad skipped value", R"({"x": [1 2], "host": "h", "port": 1})", "Expected ']'");
+
+    return 0;
+}
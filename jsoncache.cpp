@@ -0,0 +1,218 @@
+#include "jsoncache.h"
+#include <cstdio>
+#include <chrono>
+#include <cstring>
+#include <filesystem>
+#include <fstream>
+#include <sstream>
+
+namespace fs = std::filesystem;
+
+namespace {
+
+const char     kMagic[8] = {'J','S','F','Y','C','A','C','H'};
+const uint32_t kVersion  = 2;
+
+constexpr uint64_t kMul1 = 0x9E3779B97F4A7C15ULL;
+constexpr uint64_t kMul2 = 0xC2B2AE3D27D4EB4FULL;
+
+inline uint64_t mix(uint64_t h) {
+    h ^= h >> 33; h *= kMul2;
+    h ^= h >> 29; h *= kMul1;
+    h ^= h >> 32;
+    return h;
+}
+
+void putU32(std::string& out, uint32_t v) {
+    for (int i = 0; i < 4; ++i) out += static_cast<char>((v >> (8 * i)) & 0xFF);
+}
+
+void putU64(std::string& out, uint64_t v) {
+    for (int i = 0; i < 8; ++i) out += static_cast<char>((v >> (8 * i)) & 0xFF);
+}
+
+// Bounds-checked little-endian reader over an entry file.
+struct Reader {
+    const std::string& buf;
+    size_t pos = 0;
+
+    bool need(size_t n) const { return n <= buf.size() - pos; }
+    bool u32(uint32_t& v) {
+        if (!need(4)) return false;
+        v = 0;
+        for (int i = 3; i >= 0; --i) v = (v << 8) | static_cast<unsigned char>(buf[pos + i]);
+        pos += 4;
+        return true;
+    }
+    bool u64(uint64_t& v) {
+        if (!need(8)) return false;
+        v = 0;
+        for (int i = 7; i >= 0; --i) v = (v << 8) | static_cast<unsigned char>(buf[pos + i]);
+        pos += 8;
+        return true;
+    }
+    bool bytes(std::string& s, size_t n) {
+        if (!need(n)) return false;
+        s.assign(buf, pos, n);
+        pos += n;
+        return true;
+    }
+};
+
+// Size and mtime of the file on disk; mtime 0 means unknown.
+bool fileStat(const std::string& path, uint64_t& size, uint64_t& mtime) {
+    std::error_code ec;
+    auto sz = fs::file_size(path, ec);
+    if (ec) return false;
+    auto t = fs::last_write_time(path, ec);
+    if (ec) return false;
+    size  = static_cast<uint64_t>(sz);
+    mtime = static_cast<uint64_t>(t.time_since_epoch().count());
+    return true;
+}
+
+// An mtime within this much of the clock may still be shared by a later
+// write of the same size, so it is not trusted for the stat-only lookup.
+constexpr auto kRacyWindow = std::chrono::seconds(2);
+
+uint64_t trustedMtime(const std::string& path, uint64_t mtime) {
+    std::error_code ec;
+    auto t = fs::last_write_time(path, ec);
+    if (ec || fs::file_time_type::clock::now() - t < kRacyWindow) return 0;
+    return mtime;
+}
+
+} // namespace
+
+/* --------------------------------------------------------------- */
+uint64_t hashBytes(std::string_view data, uint64_t seed) {
+    uint64_t h = seed ^ (data.size() * kMul1);
+    const char* p = data.data();
+    size_t n = data.size();
+    for (; n >= 8; p += 8, n -= 8) {
+        uint64_t w;
+        std::memcpy(&w, p, 8);
+        h = (h ^ mix(w * kMul2)) * kMul1;
+    }
+    uint64_t tail = 0;
+    std::memcpy(&tail, p, n);
+    h = (h ^ mix(tail * kMul2 + n)) * kMul1;
+    return mix(h);
+}
+
+/* --------------------------------------------------------------- */
+JsonCache::JsonCache(std::string dir) : dir_(std::move(dir)) {
+    std::error_code ec;
+    fs::create_directories(dir_, ec);
+    if (ec) throw std::runtime_error("Cannot create cache directory: " + dir_);
+}
+
+std::string JsonCache::entryPath(const std::string& path, uint64_t optionsKey) const {
+    std::error_code ec;
+    std::string abs = fs::absolute(path, ec).lexically_normal().string();
+    if (ec) abs = path;
+    char name[32];
+    std::snprintf(name, sizeof name, "%016llx.jfc",
+                  static_cast<unsigned long long>(hashBytes(abs, optionsKey)));
+    return (fs::path(dir_) / name).string();
+}
+
+/* --------------------------------------------------------------- */
+bool JsonCache::lookup(const std::string& path, uint64_t optionsKey, JsonCacheEntry& out) const {
+    return load(path, nullptr, optionsKey, out);
+}
+
+bool JsonCache::lookup(const std::string& path, std::string_view content,
+                       uint64_t optionsKey, JsonCacheEntry& out) const {
+    return load(path, &content, optionsKey, out);
+}
+
+bool JsonCache::load(const std::string& path, const std::string_view* content,
+                     uint64_t optionsKey, JsonCacheEntry& out) const {
+    uint64_t curSize = 0, curMtime = 0;
+    const bool statted = fileStat(path, curSize, curMtime);
+    if (!content && !statted) return false;
+
+    std::ifstream f(entryPath(path, optionsKey), std::ios::binary);
+    if (!f) return false;
+    std::stringstream ss; ss << f.rdbuf();
+    std::string buf = ss.str();
+
+    Reader r{buf};
+    std::string magic;
+    uint32_t version, hasLint, count;
+    uint64_t fileSize, mtime, size, hash, key;
+    if (!r.bytes(magic, sizeof kMagic) || std::memcmp(magic.data(), kMagic, sizeof kMagic) != 0)
+        return false;
+    if (!r.u32(version) || version != kVersion) return false;
+    if (!r.u64(key) || key != optionsKey) return false;
+    if (!r.u64(fileSize) || !r.u64(mtime) || !r.u64(size) || !r.u64(hash)) return false;
+    if (content) {
+        if (size != content->size() || hash != hashBytes(*content)) return false;
+    } else if (mtime == 0 || fileSize != curSize || mtime != curMtime) {
+        return false;
+    }
+
+    JsonCacheEntry e;
+    if (!r.u32(hasLint) || !r.u32(count)) return false;
+    e.hasLint = hasLint != 0;
+    for (uint32_t i = 0; i < count; ++i) {
+        uint32_t sev, line, col, len;
+        JsonLintIssue iss;
+        if (!r.u32(sev) || !r.u32(line) || !r.u32(col) || !r.u32(len) || sev > 2) return false;
+        iss.severity = static_cast<JsonLintIssue::Severity>(sev);
+        iss.line     = static_cast<int>(line);
+        iss.column   = static_cast<int>(col);
+        if (!r.bytes(iss.message, len)) return false;
+        e.issues.push_back(std::move(iss));
+    }
+    uint64_t snapLen;
+    if (!r.u64(snapLen) || !r.bytes(e.snapshot, static_cast<size_t>(snapLen))) return false;
+    out = std::move(e);
+
+    // Same content under a new mtime: refresh so that the next run can take
+    // the stat-only path.
+    if (content && statted && (curMtime != mtime || curSize != fileSize)
+        && trustedMtime(path, curMtime) != 0)
+        store(path, *content, optionsKey, out);
+    return true;
+}
+
+/* --------------------------------------------------------------- */
+void JsonCache::store(const std::string& path, std::string_view content,
+                      uint64_t optionsKey, const JsonCacheEntry& entry) const {
+    uint64_t fileSize = 0, mtime = 0;
+    if (fileStat(path, fileSize, mtime)) mtime = trustedMtime(path, mtime);
+
+    std::string buf(kMagic, sizeof kMagic);
+    putU32(buf, kVersion);
+    putU64(buf, optionsKey);
+    putU64(buf, fileSize);
+    putU64(buf, mtime);
+    putU64(buf, content.size());
+    putU64(buf, hashBytes(content));
+    putU32(buf, entry.hasLint ? 1 : 0);
+    putU32(buf, static_cast<uint32_t>(entry.issues.size()));
+    for (const auto& iss : entry.issues) {
+        putU32(buf, static_cast<uint32_t>(iss.severity));
+        putU32(buf, static_cast<uint32_t>(iss.line));
+        putU32(buf, static_cast<uint32_t>(iss.column));
+        putU32(buf, static_cast<uint32_t>(iss.message.size()));
+        buf += iss.message;
+    }
+    putU64(buf, entry.snapshot.size());
+    buf += entry.snapshot;
+
+    // Write beside the entry and rename so readers never see a partial file.
+    std::string target = entryPath(path, optionsKey);
+    std::string tmp = target + ".tmp" + std::to_string(hashBytes(buf));
+    {
+        std::ofstream f(tmp, std::ios::binary | std::ios::trunc);
+        if (!f) return;                       // caching is best-effort
+        f.write(buf.data(), static_cast<std::streamsize>(buf.size()));
+        if (!f) { f.close(); std::error_code ec; fs::remove(tmp, ec); return; }
+    }
+    std::error_code ec;
+    fs::rename(tmp, target, ec);
+    if (ec) fs::remove(tmp, ec);
+}
@@ -0,0 +1,49 @@
+#ifndef JSONCACHE_H
+#define JSONCACHE_H
+
+#include <cstdint>
+#include <string>
+#include <string_view>
+#include <vector>
+#include "jsonlinter.h"
+
+// Fast non-cryptographic 64-bit hash, 8 bytes per step.
+uint64_t hashBytes(std::string_view data, uint64_t seed = 0);
+
+// What the cache remembers about one input file.
+struct JsonCacheEntry {
+    bool hasLint = false;
+    std::vector<JsonLintIssue> issues;  // valid when hasLint
+    std::string snapshot;               // binary document (see jsonbinary.h), may be empty
+};
+
+// Opt-in on-disk cache of per-file results, one entry file per input path.
+// An entry is keyed by path, file size and mtime: while the file's size and
+// mtime match, it is answered without reading the file. Otherwise the entry
+// is verified against a hash of the content, and a touched-but-unchanged
+// file gets its new mtime recorded rather than being re-parsed. An mtime too
+// close to the time of writing is not recorded, since the file could still
+// change within the same timestamp. optionsKey distinguishes runs whose
+// results differ (e.g. --jsonc, --fix).
+class JsonCache {
+public:
+    explicit JsonCache(std::string dir);
+
+    // From the file's size and mtime alone; false means "read and verify".
+    bool lookup(const std::string& path, uint64_t optionsKey, JsonCacheEntry& out) const;
+    // Verified against `content`, the file's (decompressed) text.
+    bool lookup(const std::string& path, std::string_view content,
+                uint64_t optionsKey, JsonCacheEntry& out) const;
+    void store(const std::string& path, std::string_view content,
+               uint64_t optionsKey, const JsonCacheEntry& entry) const;
+
+private:
+    std::string entryPath(const std::string& path, uint64_t optionsKey) const;
+    // Reads the entry; `content` null skips the hash check for the stat one.
+    bool load(const std::string& path, const std::string_view* content,
+              uint64_t optionsKey, JsonCacheEntry& out) const;
+
+    std::string dir_;
+};
+
+#endif
@@ -0,0 +1,254 @@
+#include "jsoncompress.h"
+#include <algorithm>
+#include <filesystem>
+#include <fstream>
+#include <stdexcept>
+#include <utility>
+
+#ifdef JSONIFY_WITH_ZLIB
+#  include <zlib.h>
+#endif
+#ifdef JSONIFY_WITH_ZSTD
+#  include <zstd.h>
+#endif
+
+namespace {
+
+const size_t kInputChunk = size_t(256) << 10;   // compressed bytes read at a time
+const size_t kMagicBytes = 4;
+
+JsonCompression compressionOf(std::string_view magic) {
+    if (magic.size() >= 2 && magic.substr(0, 2) == "\x1F\x8B") return JsonCompression::Gzip;
+    if (magic.size() >= 4 && magic.substr(0, 4) == "\x28\xB5\x2F\xFD") return JsonCompression::Zstd;
+    return JsonCompression::None;
+}
+
+std::string readMagic(std::istream& in) {
+    std::string magic(kMagicBytes, '\0');
+    in.read(&magic[0], static_cast<std::streamsize>(kMagicBytes));
+    magic.resize(static_cast<size_t>(in.gcount()));
+    return magic;
+}
+
+} // namespace
+
+JsonCompression detectCompression(const std::string& filename) {
+    std::ifstream f(filename, std::ios::binary);
+    return compressionOf(readMagic(f));
+}
+
+/* --------------------------------------------------------------- */
+JsonCompressedReader::JsonCompressedReader(const std::string& filename, size_t bufferBytes, size_t buffers)
+    : JsonCompressedReader(std::ifstream(filename, std::ios::binary), std::string(), filename,
+                           bufferBytes, buffers) {}
+
+JsonCompressedReader::JsonCompressedReader(std::ifstream in, std::string prefix, const std::string& filename,
+                                           size_t bufferBytes, size_t buffers)
+    : filename_(filename), in_(std::move(in)), prefix_(std::move(prefix)),
+      bufferBytes_(bufferBytes), slots_(buffers < 2 ? 2 : buffers) {
+    if (!in_.is_open()) throw std::runtime_error("Cannot open " + filename_);
+    for (auto& s : slots_) s.data.reset(new char[bufferBytes_]);
+    thread_ = std::thread([this] { produce(); });
+}
+
+JsonCompressedReader::~JsonCompressedReader() {
+    {
+        std::lock_guard<std::mutex> lock(m_);
+        stop_ = true;
+    }
+    cv_.notify_all();
+    thread_.join();
+}
+
+std::string_view JsonCompressedReader::next() {
+    std::unique_lock<std::mutex> lock(m_);
+    if (held_) {
+        held_ = false;
+        --inUse_;
+        head_ = (head_ + 1) % slots_.size();
+        cv_.notify_all();
+    }
+    cv_.wait(lock, [this] { return filled_ > 0 || done_; });
+    if (filled_ > 0) {
+        --filled_;
+        held_ = true;
+        const Slot& s = slots_[head_];
+        return std::string_view(s.data.get(), s.size);
+    }
+    if (error_) std::rethrow_exception(error_);
+    return std::string_view();
+}
+
+/* --------------------------------------------------------------- */
+JsonCompressedReader::Slot* JsonCompressedReader::acquire() {
+    std::unique_lock<std::mutex> lock(m_);
+    cv_.wait(lock, [this] { return inUse_ < slots_.size() || stop_; });
+    if (stop_) return nullptr;
+    Slot* s = &slots_[tail_];
+    s->size = 0;
+    return s;
+}
+
+void JsonCompressedReader::publish() {
+    {
+        std::lock_guard<std::mutex> lock(m_);
+        if (slots_[tail_].size == 0) return;
+        ++filled_;
+        ++inUse_;
+        tail_ = (tail_ + 1) % slots_.size();
+    }
+    cv_.notify_all();
+}
+
+void JsonCompressedReader::produce() {
+    try {
+        if (prefix_.empty()) prefix_ = readMagic(in_);
+        switch (compressionOf(prefix_)) {
+            case JsonCompression::None: copyPlain();   break;
+            case JsonCompression::Gzip: inflateGzip(); break;
+            case JsonCompression::Zstd: inflateZstd(); break;
+        }
+    } catch (...) {
+        std::lock_guard<std::mutex> lock(m_);
+        error_ = std::current_exception();
+    }
+    {
+        std::lock_guard<std::mutex> lock(m_);
+        done_ = true;
+    }
+    cv_.notify_all();
+}
+
+size_t JsonCompressedReader::readInput(char* buf, size_t n) {
+    size_t got = prefix_.copy(buf, n);
+    prefix_.erase(0, got);
+    if (got < n) {
+        in_.read(buf + got, static_cast<std::streamsize>(n - got));
+        got += static_cast<size_t>(in_.gcount());
+    }
+    if (in_.bad()) throw std::runtime_error("Cannot read " + filename_);
+    return got;
+}
+
+void JsonCompressedReader::copyPlain() {
+    while (Slot* s = acquire()) {
+        s->size = readInput(s->data.get(), bufferBytes_);
+        if (s->size == 0) return;
+        publish();
+    }
+}
+
+// Both decoders fill the current slot until it is full, then move on to the
+// next one. New input is read only when the decoder left output space
+// unused, i.e. it has nothing buffered internally.
+#ifdef JSONIFY_WITH_ZLIB
+void JsonCompressedReader::inflateGzip() {
+    z_stream zs{};
+    if (inflateInit2(&zs, 15 + 32) != Z_OK)   // 15-bit window, gzip or zlib header
+        throw std::runtime_error("Cannot initialise zlib");
+    struct End { z_stream* zs; ~End() { inflateEnd(zs); } } end{&zs};
+
+    std::unique_ptr<char[]> input(new char[kInputChunk]);
+    Slot* s = acquire();
+    bool needInput = true, inMember = false;
+    while (s) {
+        if (zs.avail_in == 0 && needInput) {
+            zs.next_in = reinterpret_cast<Bytef*>(input.get());
+            zs.avail_in = static_cast<uInt>(readInput(input.get(), kInputChunk));
+            if (zs.avail_in == 0) break;
+        }
+        zs.next_out = reinterpret_cast<Bytef*>(s->data.get() + s->size);
+        zs.avail_out = static_cast<uInt>(bufferBytes_ - s->size);
+        const uInt availIn = zs.avail_in;
+        int rc = inflate(&zs, Z_NO_FLUSH);
+        s->size = bufferBytes_ - zs.avail_out;
+        needInput = zs.avail_out != 0;
+        if (zs.avail_in != availIn) inMember = true;
+        if (rc == Z_STREAM_END) {
+            inMember = false;
+            inflateReset(&zs);   // concatenated gzip members continue the output
+        } else if (rc != Z_OK && rc != Z_BUF_ERROR) {
+            throw std::runtime_error("Corrupt gzip data in " + filename_ + ": "
+                                     + (zs.msg ? zs.msg : "inflate failed"));
+        }
+        if (s->size == bufferBytes_) {
+            publish();
+            s = acquire();
+        }
+    }
+    if (!s) return;
+    publish();
+    if (inMember) throw std::runtime_error("Truncated gzip data in " + filename_);
+}
+#else
+void JsonCompressedReader::inflateGzip() {
+    throw std::runtime_error(filename_ + " is gzip-compressed, but this build has no zlib support");
+}
+#endif
+
+#ifdef JSONIFY_WITH_ZSTD
+void JsonCompressedReader::inflateZstd() {
+    ZSTD_DStream* ds = ZSTD_createDStream();
+    if (!ds) throw std::runtime_error("Cannot initialise zstd");
+    struct Free { ZSTD_DStream* ds; ~Free() { ZSTD_freeDStream(ds); } } guard{ds};
+    ZSTD_initDStream(ds);
+
+    std::unique_ptr<char[]> input(new char[kInputChunk]);
+    ZSTD_inBuffer inBuf{input.get(), 0, 0};
+    Slot* s = acquire();
+    bool needInput = true, inFrame = false;
+    while (s) {
+        if (inBuf.pos == inBuf.size && needInput) {
+            inBuf.size = readInput(input.get(), kInputChunk);
+            inBuf.pos = 0;
+            if (inBuf.size == 0) break;
+        }
+        ZSTD_outBuffer outBuf{s->data.get(), bufferBytes_, s->size};
+        const size_t inPos = inBuf.pos, outPos = outBuf.pos;
+        size_t rc = ZSTD_decompressStream(ds, &outBuf, &inBuf);   // 0: a frame just ended
+        if (ZSTD_isError(rc))
+            throw std::runtime_error("Corrupt zstd data in " + filename_ + ": " + ZSTD_getErrorName(rc));
+        if (inBuf.pos != inPos || outBuf.pos != outPos) inFrame = rc != 0;
+        s->size = outBuf.pos;
+        needInput = outBuf.pos < outBuf.size;
+        if (s->size == bufferBytes_) {
+            publish();
+            s = acquire();
+        }
+    }
+    if (!s) return;
+    publish();
+    if (inFrame) throw std::runtime_error("Truncated zstd data in " + filename_);
+}
+#else
+void JsonCompressedReader::inflateZstd() {
+    throw std::runtime_error(filename_ + " is zstd-compressed, but this build has no zstd support");
+}
+#endif
+
+/* --------------------------------------------------------------- */
+// Plain files are read straight into the result; only compressed ones go
+// through the reader thread, handed the stream so nothing is read twice.
+std::string readJsonInput(const std::string& filename) {
+    std::ifstream f(filename, std::ios::binary);
+    if (!f) throw std::runtime_error("Cannot open " + filename);
+    std::string magic = readMagic(f);
+    if (compressionOf(magic) == JsonCompression::None) {
+        std::string& text = magic;
+        std::error_code ec;
+        const uintmax_t size = std::filesystem::file_size(filename, ec);   // fails for pipes
+        if (!ec) text.reserve(static_cast<size_t>(size) + 1);
+        for (size_t got = text.size(); f;) {
+            text.resize(std::max(text.capacity(), got + std::max(got, kInputChunk)));   // grows geometrically
+            f.read(&text[got], static_cast<std::streamsize>(text.size() - got));
+            got += static_cast<size_t>(f.gcount());
+            text.resize(got);
+        }
+        return text;
+    }
+    JsonCompressedReader reader(std::move(f), std::move(magic), filename, size_t(1) << 20, 4);
+    std::string text;
+    for (std::string_view chunk = reader.next(); !chunk.empty(); chunk = reader.next())
+        text.append(chunk);
+    return text;
+}
@@ -0,0 +1,88 @@
+#ifndef JSONCOMPRESS_H
+#define JSONCOMPRESS_H
+
+#include <condition_variable>
+#include <cstddef>
+#include <exception>
+#include <fstream>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <string_view>
+#include <thread>
+#include <vector>
+
+// Compressed input. gzip needs a build with zlib (JSONIFY_WITH_ZLIB), zstd
+// one with libzstd (JSONIFY_WITH_ZSTD); CMake, make and build.sh enable each
+// when found.
+enum class JsonCompression { None, Gzip, Zstd };
+
+// Detected from the file's magic bytes, not its name. None if the file
+// cannot be read.
+JsonCompression detectCompression(const std::string& filename);
+
+// Reads a file on a dedicated thread into a ring of reusable buffers while
+// the caller consumes them, decompressing it on the way if its first bytes
+// say so. Inflating and parsing overlap, and neither a temporary file nor
+// the whole compressed file is ever held. The file is read once from the
+// start, so pipes such as /dev/stdin work too.
+class JsonCompressedReader {
+public:
+    explicit JsonCompressedReader(const std::string& filename,
+                                  size_t bufferBytes = size_t(1) << 20, size_t buffers = 4);
+    // Stops the reader thread and joins it. The thread notices the request
+    // between reads only: a read from a pipe or FIFO whose writer is still
+    // open blocks, and with it this destructor, until data or end of file
+    // arrives. Regular files never block this way.
+    ~JsonCompressedReader();
+    JsonCompressedReader(const JsonCompressedReader&) = delete;
+    JsonCompressedReader& operator=(const JsonCompressedReader&) = delete;
+
+    // The next run of decompressed bytes; empty at the end of the input.
+    // The view is valid until the following call. Decompression errors
+    // (corrupt or truncated data) are rethrown here once the data before
+    // them has been consumed.
+    std::string_view next();
+
+private:
+    struct Slot {
+        std::unique_ptr<char[]> data;
+        size_t size = 0;
+    };
+
+    // Continues reading `in` after the bytes already taken into `prefix`.
+    JsonCompressedReader(std::ifstream in, std::string prefix, const std::string& filename,
+                         size_t bufferBytes, size_t buffers);
+    friend std::string readJsonInput(const std::string& filename);
+
+    void produce();
+    Slot* acquire();     // producer: waits for a free slot, null when stopping
+    void publish();      // producer: hands the current slot to the consumer
+    size_t readInput(char* buf, size_t n);   // prefix_ first, then in_
+    void inflateGzip();
+    void inflateZstd();
+    void copyPlain();
+
+    std::string     filename_;
+    std::ifstream   in_;
+    std::string     prefix_;
+    size_t          bufferBytes_;
+    std::vector<Slot> slots_;
+
+    std::mutex              m_;
+    std::condition_variable cv_;
+    size_t tail_ = 0;              // producer's slot
+    size_t head_ = 0;              // consumer's slot
+    size_t filled_ = 0;            // published, not yet taken by next()
+    size_t inUse_ = 0;             // filled or held by the consumer
+    bool   held_ = false;          // the consumer holds slots_[head_]
+    bool   done_ = false, stop_ = false;
+    std::exception_ptr error_;
+    std::thread thread_;           // declared last: starts after the state above
+};
+
+// The whole text of a file, decompressed on a reader thread when it is
+// compressed.
+std::string readJsonInput(const std::string& filename);
+
+#endif // JSONCOMPRESS_H
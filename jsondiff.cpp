@@ -0,0 +1,206 @@
+#include "jsondiff.h"
+#include <algorithm>
+#include <cstring>
+#include "jsoncache.h"
+
+namespace {
+
+const uint64_t kMul = 0x9E3779B97F4A7C15ULL;
+
+// splitmix64 finalizer
+uint64_t mix(uint64_t x) {
+    x ^= x >> 30; x *= 0xBF58476D1CE4E5B9ULL;
+    x ^= x >> 27; x *= 0x94D049BB133111EBULL;
+    return x ^ (x >> 31);
+}
+
+// distinct seeds keep e.g. "1" and 1, or [] and {} apart
+enum Seed : uint64_t { kSeedNull = 1, kSeedBool, kSeedNumber, kSeedString, kSeedArray, kSeedObject, kSeedKey };
+
+// Containers smaller than this are rehashed on demand instead of recorded:
+// bounded work per lookup, and far fewer map entries for record-heavy files.
+const size_t kRecordedSubtreeNodes = 64;
+
+// `nodes` accumulates the size of the subtree
+uint64_t hashNode(const JsonValue* v, JsonSubtreeHashes* out, size_t& nodes) {
+    using Type = JsonValue::Type;
+    ++nodes;
+    if (!v) return mix(kSeedNull * kMul);
+
+    uint64_t h = 0;
+    const size_t first = nodes;
+    switch (v->getType()) {
+    case Type::Null:
+        return mix(kSeedNull * kMul);
+    case Type::Bool:
+        return mix(kSeedBool * kMul + (v->getBool() ? 1 : 0));
+    case Type::Number: {
+        double d = v->getNumber();
+        if (d == 0) d = 0;   // -0 == 0
+        uint64_t bits;
+        std::memcpy(&bits, &d, sizeof bits);
+        return mix(bits ^ mix(kSeedNumber * kMul));
+    }
+    case Type::String:
+        return hashBytes(v->getString(), kSeedString);
+    case Type::Array: {
+        const auto& a = v->getArray();
+        h = mix(kSeedArray * kMul + a.size());
+        for (const auto& child : a) h = mix(h * kMul + hashNode(child.get(), out, nodes));
+        break;
+    }
+    case Type::Object: {
+        // a sum of per-member hashes does not depend on iteration order
+        const auto& o = v->getObject();
+        uint64_t sum = 0;
+        for (const auto& kv : o)
+            sum += mix(hashBytes(kv.first, kSeedKey) + hashNode(kv.second.get(), out, nodes) * kMul);
+        h = mix(sum ^ mix(kSeedObject * kMul + o.size()));
+        break;
+    }
+    }
+    if (out && nodes - first >= kRecordedSubtreeNodes) out->emplace(v, h);
+    return h;
+}
+
+uint64_t hashNode(const JsonValue* v, JsonSubtreeHashes* out) {
+    size_t nodes = 0;
+    return hashNode(v, out, nodes);
+}
+
+class Differ {
+public:
+    Differ(const JsonSubtreeHashes& ha, const JsonSubtreeHashes& hb, std::vector<JsonDifference>& out)
+        : ha_(ha), hb_(hb), out_(out) {}
+
+    void diff(const std::shared_ptr<JsonValue>& a, const std::shared_ptr<JsonValue>& b) {
+        if (same(a, b)) return;
+        Type ta = typeOf(a), tb = typeOf(b);
+        if (ta != tb || (ta != Type::Array && ta != Type::Object)) {
+            report(JsonDifference::Kind::Changed, a, b);
+            return;
+        }
+        if (ta == Type::Array) diffArrays(a->getArray(), b->getArray());
+        else                   diffObjects(a->getObject(), b->getObject());
+    }
+
+private:
+    using Type = JsonValue::Type;
+
+    static Type typeOf(const std::shared_ptr<JsonValue>& v) { return v ? v->getType() : Type::Null; }
+
+    // Bounded work: scalars by value, recorded subtrees by hash, and small
+    // unrecorded containers by direct comparison (cheaper than hashing both).
+    bool same(const std::shared_ptr<JsonValue>& a, const std::shared_ptr<JsonValue>& b) const {
+        Type t = typeOf(a);
+        if (t != typeOf(b)) return false;
+        switch (t) {
+        case Type::Null:   return true;
+        case Type::Bool:   return a->getBool() == b->getBool();
+        case Type::Number: return a->getNumber() == b->getNumber();
+        case Type::String: return a->getString() == b->getString();
+        default: break;
+        }
+        auto ia = ha_.find(a.get()), ib = hb_.find(b.get());
+        if (ia != ha_.end() && ib != hb_.end()) return ia->second == ib->second;
+        if (ia != ha_.end() || ib != hb_.end()) return false;   // sizes differ too much
+
+        if (t == Type::Array) {
+            const auto& x = a->getArray();
+            const auto& y = b->getArray();
+            if (x.size() != y.size()) return false;
+            for (size_t i = 0; i < x.size(); ++i)
+                if (!same(x[i], y[i])) return false;
+            return true;
+        }
+        const auto& x = a->getObject();
+        const auto& y = b->getObject();
+        if (x.size() != y.size()) return false;
+        for (const auto& kv : x) {
+            auto it = y.find(kv.first);
+            if (it == y.end() || !same(kv.second, it->second)) return false;
+        }
+        return true;
+    }
+
+    void report(JsonDifference::Kind kind, const std::shared_ptr<JsonValue>& a,
+                const std::shared_ptr<JsonValue>& b) {
+        out_.push_back({kind, path_, a, b});
+    }
+
+    void child(std::string_view token, const std::shared_ptr<JsonValue>& a,
+               const std::shared_ptr<JsonValue>& b, JsonDifference::Kind kind) {
+        size_t len = path_.size();
+        appendJsonPointer(path_, token);
+        if (kind == JsonDifference::Kind::Changed) diff(a, b);
+        else report(kind, a, b);
+        path_.resize(len);
+    }
+
+    void diffArrays(const JsonArray& a, const JsonArray& b) {
+        const size_t n = std::min(a.size(), b.size());
+        size_t prefix = 0, suffix = 0;
+        while (prefix < n && same(a[prefix], b[prefix])) ++prefix;
+        while (suffix < n - prefix && same(a[a.size() - 1 - suffix], b[b.size() - 1 - suffix])) ++suffix;
+
+        const size_t ma = a.size() - prefix - suffix, mb = b.size() - prefix - suffix;
+        const size_t m = std::min(ma, mb);
+        for (size_t i = prefix; i < prefix + m; ++i)
+            child(std::to_string(i), a[i], b[i], JsonDifference::Kind::Changed);
+        for (size_t i = prefix + m; i < prefix + ma; ++i)
+            child(std::to_string(i), a[i], nullptr, JsonDifference::Kind::Removed);
+        for (size_t i = prefix + m; i < prefix + mb; ++i)
+            child(std::to_string(i), nullptr, b[i], JsonDifference::Kind::Added);
+    }
+
+    void diffObjects(const JsonObject& a, const JsonObject& b) {
+        struct Entry {
+            const JsonString* key;
+            JsonDifference::Kind kind;
+            const std::shared_ptr<JsonValue>* a;
+            const std::shared_ptr<JsonValue>* b;
+        };
+        std::vector<Entry> entries;
+        for (const auto& kv : a) {
+            auto it = b.find(kv.first);
+            if (it == b.end())                  entries.push_back({&kv.first, JsonDifference::Kind::Removed, &kv.second, nullptr});
+            else if (!same(kv.second, it->second)) entries.push_back({&kv.first, JsonDifference::Kind::Changed, &kv.second, &it->second});
+        }
+        for (const auto& kv : b) {
+            if (!a.count(kv.first)) entries.push_back({&kv.first, JsonDifference::Kind::Added, nullptr, &kv.second});
+        }
+        std::sort(entries.begin(), entries.end(),
+                  [](const Entry& x, const Entry& y) { return *x.key < *y.key; });
+
+        static const std::shared_ptr<JsonValue> none;
+        for (const Entry& e : entries)
+            child(*e.key, e.a ? *e.a : none, e.b ? *e.b : none, e.kind);
+    }
+
+    const JsonSubtreeHashes& ha_;
+    const JsonSubtreeHashes& hb_;
+    std::vector<JsonDifference>& out_;
+    std::string path_;
+};
+
+} // namespace
+
+/* --------------------------------------------------------------- */
+uint64_t hashJson(const std::shared_ptr<JsonValue>& value, JsonSubtreeHashes* hashes) {
+    return hashNode(value.get(), hashes);
+}
+
+std::vector<JsonDifference> diffJson(const std::shared_ptr<JsonValue>& a, const JsonSubtreeHashes& ha,
+                                     const std::shared_ptr<JsonValue>& b, const JsonSubtreeHashes& hb) {
+    std::vector<JsonDifference> out;
+    Differ(ha, hb, out).diff(a, b);
+    return out;
+}
+
+std::vector<JsonDifference> diffJson(const std::shared_ptr<JsonValue>& a,
+                                     const std::shared_ptr<JsonValue>& b) {
+    JsonSubtreeHashes ha, hb;
+    hashJson(a, &ha);
+    hashJson(b, &hb);
+    return diffJson(a, ha, b, hb);
+}
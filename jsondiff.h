@@ -0,0 +1,39 @@
+#ifndef JSONDIFF_H
+#define JSONDIFF_H
+
+#include <cstdint>
+#include <memory>
+#include <string>
+#include <string_view>
+#include <unordered_map>
+#include <vector>
+#include "jsonparser.h"
+#include "jsonpointer.h"
+
+// Structural hashes of the subtrees of a document, keyed by node. Object
+// hashes do not depend on member order, so two documents that differ only in
+// key order hash the same. Only containers with a sizeable subtree are
+// recorded; smaller ones (and scalars) are cheap to hash or compare on demand.
+using JsonSubtreeHashes = std::unordered_map<const JsonValue*, uint64_t>;
+
+// Hash of `value`; when `hashes` is given, subtree hashes are recorded in it.
+uint64_t hashJson(const std::shared_ptr<JsonValue>& value, JsonSubtreeHashes* hashes = nullptr);
+
+struct JsonDifference {
+    enum class Kind { Added, Removed, Changed };
+    Kind kind;
+    std::string path;                     // JSON Pointer (RFC 6901)
+    std::shared_ptr<JsonValue> before;    // null for Added
+    std::shared_ptr<JsonValue> after;     // null for Removed
+};
+
+// Differences between `a` and `b`, descending only into subtrees whose hashes
+// differ. Object members are compared by key (reported in key order), arrays
+// by position after matching a common prefix and suffix, so an insertion
+// reports one added element rather than a changed tail.
+std::vector<JsonDifference> diffJson(const std::shared_ptr<JsonValue>& a, const JsonSubtreeHashes& ha,
+                                     const std::shared_ptr<JsonValue>& b, const JsonSubtreeHashes& hb);
+std::vector<JsonDifference> diffJson(const std::shared_ptr<JsonValue>& a,
+                                     const std::shared_ptr<JsonValue>& b);
+
+#endif // JSONDIFF_H
@@ -7,6 +7,47 @@ void printIndent(std::ostream& os, int indent) {
     os << std::string(indent, ' ');
 }
 
+void printJsonString(std::ostream& os, std::string_view s) {
+    os << '"';
+    for (char c : s) {
+        switch (c) {
+            case '"':  os << "\\\""; break;
+            case '\\': os << "\\\\"; break;
+            case '\b': os << "\\b"; break;
+            case '\f': os << "\\f"; break;
+            case '\n': os << "\\n"; break;
+            case '\r': os << "\\r"; break;
+            case '\t': os << "\\t"; break;
+            default:   os << c; break;
+        }
+    }
+    os << '"';
+}
+
+void printJsonNumber(std::ostream& os, double n) {
+    if (std::isinf(n) || std::isnan(n)) os << "null";
+    else if (n==(long long)n) os << (long long)n;
+    else os << std::fixed << std::setprecision(15) << n;
+}
+
+void printJsonItemPrefix(std::ostream& os, const JsonString* key,
+                         int indent, int indentStep, bool compact, bool useColor) {
+    if (!compact) printIndent(os, indent + indentStep);
+    if (key) {
+        // Apply color to the key string only
+        if (useColor) os << AnsiColor::KEY;
+        printJsonString(os, *key);
+        os << ':';
+        if (useColor) os << AnsiColor::RESET;
+        if (!compact) os << ' ';
+    }
+}
+
+void printJsonItemSuffix(std::ostream& os, bool last, bool compact) {
+    if (!last) os << ',';
+    if (!compact) os << '\n';
+}
+
 // Updated function signature with the 'useColor' parameter
 void printJson(const std::shared_ptr<JsonValue>& value,
                std::ostream& os,
@@ -36,29 +77,19 @@ void printJson(const std::shared_ptr<JsonValue>& value,
         os << get_color(AnsiColor::BOOL) << (value->getBool() ? "true" : "false") << get_reset();
         break;
     case Type::Number: {
-        double n = value->getNumber();
         os << get_color(AnsiColor::NUMBER);
-        if (std::isinf(n) || std::isnan(n)) os << "null";
-        else if (n==(long long)n) os << (long long)n;
-        else os << std::fixed << std::setprecision(15) << n;
+        std::string_view lexeme = value->getLexeme();
+        if (!lexeme.empty()) os.write(lexeme.data(), static_cast<std::streamsize>(lexeme.size()));
+        else                 printJsonNumber(os, value->getNumber());
         os << get_reset();
         break;
     }
     case Type::String: {
-        os << get_color(AnsiColor::STRING) << '"';
-        for (char c : value->getString()) {
-            switch (c) {
-                case '"':  os << "\\\""; break;
-                case '\\': os << "\\\\"; break;
-                case '\b': os << "\\b"; break;
-                case '\f': os << "\\f"; break;
-                case '\n': os << "\\n"; break;
-                case '\r': os << "\\r"; break;
-                case '\t': os << "\\t"; break;
-                default:   os << c; break;
-            }
-        }
-        os << '"' << get_reset();
+        os << get_color(AnsiColor::STRING);
+        std::string_view lexeme = value->getLexeme();
+        if (!lexeme.empty()) os.write(lexeme.data(), static_cast<std::streamsize>(lexeme.size()));
+        else                 printJsonString(os, value->getString());
+        os << get_reset();
         break;
     }
     case Type::Array: {
@@ -66,11 +97,10 @@ void printJson(const std::shared_ptr<JsonValue>& value,
         os << '[';
         if (!compact && !a.empty()) os << '\n';
         for (size_t i = 0; i < a.size(); ++i) {
-            if (!compact) printIndent(os, indent + indentStep);
+            printJsonItemPrefix(os, nullptr, indent, indentStep, compact, useColor);
             // Recursive call must pass the useColor state
             printJson(a[i], os, indent + indentStep, indentStep, compact, useColor);
-            if (i + 1 < a.size()) os << ',';
-            if (!compact) os << '\n';
+            printJsonItemSuffix(os, i + 1 == a.size(), compact);
         }
         if (!compact && !a.empty()) printIndent(os, indent);
         os << ']';
@@ -82,17 +112,12 @@ void printJson(const std::shared_ptr<JsonValue>& value,
         if (!compact && !o.empty()) os << '\n';
         size_t i = 0;
         for (const auto& kv : o) {
-            if (!compact) printIndent(os, indent + indentStep);
-            
-            // Apply color to the key string only
-            os << get_color(AnsiColor::KEY) << '"' << kv.first << "\":" << get_reset();
-            os << (!compact ? " " : "");
+            printJsonItemPrefix(os, &kv.first, indent, indentStep, compact, useColor);
 
             // Recursive call must pass the useColor state
             printJson(kv.second, os, indent + indentStep, indentStep, compact, useColor);
-            
-            if (i + 1 < o.size()) os << ',';
-            if (!compact) os << '\n';
+
+            printJsonItemSuffix(os, i + 1 == o.size(), compact);
             ++i;
         }
         if (!compact && !o.empty()) printIndent(os, indent);
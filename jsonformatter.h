@@ -3,9 +3,13 @@
 
 #include <memory>
 #include <ostream>
+#include <string_view>
 #include "jsonparser.h"
 
 void printIndent(std::ostream& os, int indent);
+
+// Numbers and strings that carry a lexeme (JsonParseOptions KeepLexemes) are
+// written as their source text; other scalars are re-encoded.
 void printJson(const std::shared_ptr<JsonValue>& value,
                std::ostream& os,
                int indent = 0,
@@ -13,6 +17,20 @@ void printJson(const std::shared_ptr<JsonValue>& value,
                bool compact = false, // <-- Remove the semicolon here
                bool useColor = false); // Corrected declaration
 
+// Scalars exactly as printJson writes them: strings quoted with " \\ and the
+// short control escapes, numbers as integers when integral, otherwise fixed
+// with 15 decimals (non-finite values become null).
+void printJsonString(std::ostream& os, std::string_view s);
+void printJsonNumber(std::ostream& os, double n);
+
+// The text printJson writes around one container member: indentation and
+// escaped key before the value, separator and newline after it. `indent` is the
+// container's own indent; `key` is null for array elements. Exposed so that
+// members can be rendered out of line (see printJsonParallel) identically.
+void printJsonItemPrefix(std::ostream& os, const JsonString* key,
+                         int indent, int indentStep, bool compact, bool useColor);
+void printJsonItemSuffix(std::ostream& os, bool last, bool compact);
+
 namespace AnsiColor {
     const std::string RESET  = "\033[0m";
     const std::string KEY    = "\033[36m"; // Cyan
@@ -0,0 +1,282 @@
+#include "jsonindex.h"
+#include <algorithm>
+#include <cstring>
+#include <filesystem>
+#include <fstream>
+#include <stdexcept>
+#include <utility>
+#include <vector>
+#include "jsonbind.h"
+#include "jsonpointer.h"
+
+namespace fs = std::filesystem;
+
+namespace {
+
+const char     kMagic[8]   = {'J','S','F','Y','I','D','X','\0'};
+const uint32_t kVersion    = 1;
+const size_t   kHeaderSize = 48;
+const size_t   kEntryHeader = 13;   // kind, count, source end
+
+enum Kind : unsigned char { kArray = 5, kObject = 6 };   // tags of the binary format
+
+void putU32(std::string& out, uint32_t v) {
+    for (int i = 0; i < 4; ++i) out += static_cast<char>((v >> (8 * i)) & 0xFF);
+}
+
+void putU64(std::string& out, uint64_t v) {
+    for (int i = 0; i < 8; ++i) out += static_cast<char>((v >> (8 * i)) & 0xFF);
+}
+
+void patchU64(std::string& out, size_t at, uint64_t v) {
+    for (int i = 0; i < 8; ++i) out[at + i] = static_cast<char>((v >> (8 * i)) & 0xFF);
+}
+
+int64_t modificationTime(const std::string& file) {
+    return static_cast<int64_t>(fs::last_write_time(file).time_since_epoch().count());
+}
+
+bool isSpace(char c) { return c == ' ' || c == '\t' || c == '\n' || c == '\r'; }
+
+// Recursive scan that records the members of every open container on two
+// shared stacks and writes a table for each container worth indexing when
+// it closes, so memory stays proportional to the open containers' members.
+class IndexBuilder {
+public:
+    IndexBuilder(std::string_view text, size_t minBytes) : in_(text), text_(text), minBytes_(minBytes) {}
+
+    JsonIndexSummary run(std::string& out, uint64_t sourceSize, int64_t sourceMtime) {
+        out_.assign(kHeaderSize, '\0');
+        value(true);
+        in_.finish();
+
+        std::sort(directory_.begin(), directory_.end());
+        const uint64_t dirOff = out_.size();
+        for (const auto& d : directory_) {
+            putU64(out_, d.first);
+            putU64(out_, d.second);
+        }
+        std::string header(kMagic, sizeof kMagic);
+        putU32(header, kVersion);
+        putU32(header, 0);
+        putU64(header, sourceSize);
+        putU64(header, static_cast<uint64_t>(sourceMtime));
+        putU64(header, dirOff);
+        putU64(header, directory_.size());
+        out_.replace(0, kHeaderSize, header);
+        out = std::move(out_);
+        summary_.containers = directory_.size();
+        return summary_;
+    }
+
+private:
+    void value(bool root) {
+        const char c = in_.peek();
+        if (c != '[' && c != '{') { in_.skipValue(); return; }
+        const uint64_t start = in_.offset();
+        const size_t firstStart = starts_.size(), firstKey = keys_.size();
+        in_.expect(c);
+        const char close = c == '[' ? ']' : '}';
+        if (!in_.consume(close)) {
+            do {
+                if (c == '{') {
+                    in_.peek();
+                    const uint64_t keyStart = in_.offset();
+                    in_.readKey(scratch_);
+                    keys_.emplace_back(keyStart, in_.offset());
+                    in_.expect(':');
+                }
+                in_.peek();
+                starts_.push_back(in_.offset());
+                value(false);
+            } while (in_.consume(','));
+            in_.expect(close);
+        }
+        const uint64_t end = in_.offset();
+        if (root || end - start >= minBytes_) {
+            if (c == '[') emitArray(start, end, firstStart);
+            else          emitObject(start, end, firstStart, firstKey);
+        }
+        starts_.resize(firstStart);
+        keys_.resize(firstKey);
+    }
+
+    size_t entryHeader(Kind kind, uint64_t start, uint64_t end, size_t count) {
+        if (count > UINT32_MAX) throw std::runtime_error("Container too large to index");
+        directory_.emplace_back(start, out_.size());
+        out_ += static_cast<char>(kind);
+        putU32(out_, static_cast<uint32_t>(count));
+        putU64(out_, end);
+        summary_.entries += count;
+        return out_.size();
+    }
+
+    void emitArray(uint64_t start, uint64_t end, size_t first) {
+        entryHeader(kArray, start, end, starts_.size() - first);
+        for (size_t i = first; i < starts_.size(); ++i) putU64(out_, starts_[i]);
+    }
+
+    void emitObject(uint64_t start, uint64_t end, size_t firstStart, size_t firstKey) {
+        struct Member { std::string key; uint64_t value; };
+        std::vector<Member> members;
+        members.reserve(keys_.size() - firstKey);
+        for (size_t i = firstKey; i < keys_.size(); ++i) {
+            std::string_view raw = text_.substr(keys_[i].first, keys_[i].second - keys_[i].first);
+            Member m{std::string(), starts_[firstStart + (i - firstKey)]};
+            if (raw.find('\\') == std::string_view::npos) m.key.assign(raw.substr(1, raw.size() - 2));
+            else JsonReader(raw).readString(m.key);
+            members.push_back(std::move(m));
+        }
+        // The parser keeps the last of duplicate keys; so does the index.
+        std::stable_sort(members.begin(), members.end(),
+                         [](const Member& a, const Member& b) { return a.key < b.key; });
+        auto last = std::unique(members.rbegin(), members.rend(),
+                                [](const Member& a, const Member& b) { return a.key == b.key; });
+        members.erase(members.begin(), last.base());
+
+        size_t table = entryHeader(kObject, start, end, members.size());
+        out_.append(members.size() * 16, '\0');
+        for (size_t i = 0; i < members.size(); ++i) {
+            patchU64(out_, table + i * 16, out_.size());
+            patchU64(out_, table + i * 16 + 8, members[i].value);
+            putU32(out_, static_cast<uint32_t>(members[i].key.size()));
+            out_ += members[i].key;
+        }
+    }
+
+    JsonReader       in_;
+    std::string_view text_;
+    size_t           minBytes_;
+    std::vector<uint64_t> starts_;                      // value starts of open containers
+    std::vector<std::pair<uint64_t, uint64_t>> keys_;   // quoted key ranges of open objects
+    std::vector<std::pair<uint64_t, uint64_t>> directory_;
+    std::string      out_;
+    std::string      scratch_;
+    JsonIndexSummary summary_;
+};
+
+} // namespace
+
+std::string jsonIndexPath(const std::string& sourceFile) { return sourceFile + ".jidx"; }
+
+JsonIndexSummary buildJsonIndex(const std::string& sourceFile, const std::string& indexFile,
+                                size_t minContainerBytes) {
+    const int64_t mtime = modificationTime(sourceFile);
+    JsonMappedFile source(sourceFile);
+    std::string out;
+    IndexBuilder builder(std::string_view(source.data(), source.size()), minContainerBytes);
+    JsonIndexSummary summary = builder.run(out, source.size(), mtime);
+
+    std::ofstream f(indexFile, std::ios::binary);
+    if (!f.write(out.data(), static_cast<std::streamsize>(out.size())))
+        throw std::runtime_error("Cannot write " + indexFile);
+    return summary;
+}
+
+/* --------------------------------------------------------------- */
+JsonIndex::JsonIndex(const std::string& sourceFile, const std::string& indexFile)
+    : indexFile_(indexFile), source_(sourceFile), index_(indexFile) {
+    if (index_.size() < kHeaderSize || std::memcmp(index_.data(), kMagic, sizeof kMagic) != 0)
+        throw std::runtime_error("Not a jsonify index: " + indexFile);
+    if (readU32(8) != kVersion)
+        throw std::runtime_error("Unsupported index version: " + indexFile);
+    directory_      = readU64(32);
+    directoryCount_ = readU64(40);
+    bytes(directory_, directoryCount_ * 16);
+    fresh_ = readU64(16) == source_.size()
+             && static_cast<int64_t>(readU64(24)) == modificationTime(sourceFile);
+    while (rootStart_ < source_.size() && isSpace(source_.data()[rootStart_])) ++rootStart_;
+}
+
+const unsigned char* JsonIndex::bytes(uint64_t off, uint64_t len) const {
+    if (off > index_.size() || len > index_.size() - off)
+        throw std::runtime_error("Corrupt index: " + indexFile_);
+    return reinterpret_cast<const unsigned char*>(index_.data()) + off;
+}
+
+uint32_t JsonIndex::readU32(uint64_t off) const {
+    const unsigned char* b = bytes(off, 4);
+    uint32_t v = 0;
+    for (int i = 3; i >= 0; --i) v = (v << 8) | b[i];
+    return v;
+}
+
+uint64_t JsonIndex::readU64(uint64_t off) const {
+    const unsigned char* b = bytes(off, 8);
+    uint64_t v = 0;
+    for (int i = 7; i >= 0; --i) v = (v << 8) | b[i];
+    return v;
+}
+
+std::string_view JsonIndex::keyAt(uint64_t off) const {
+    uint32_t len = readU32(off);
+    return std::string_view(reinterpret_cast<const char*>(bytes(off + 4, len)), len);
+}
+
+uint64_t JsonIndex::findContainer(uint64_t start) const {
+    uint64_t lo = 0, hi = directoryCount_;
+    while (lo < hi) {
+        uint64_t mid = lo + (hi - lo) / 2;
+        uint64_t s = readU64(directory_ + mid * 16);
+        if (s == start) return readU64(directory_ + mid * 16 + 8);
+        if (s < start) lo = mid + 1;
+        else           hi = mid;
+    }
+    return 0;
+}
+
+// End of the unindexed value at `start`, found by scanning just that value.
+uint64_t JsonIndex::valueEnd(uint64_t start, uint64_t bound) const {
+    if (start > bound || bound > source_.size())
+        throw std::runtime_error("Corrupt index: " + indexFile_);
+    JsonReader in(std::string_view(source_.data() + start, bound - start));
+    in.skipValue();
+    return start + in.offset();
+}
+
+std::shared_ptr<JsonValue> JsonIndex::query(std::string_view pointer, std::pmr::memory_resource* mr,
+                                            std::string* lexemes) const {
+    const std::vector<std::string> tokens = parseJsonPointer(pointer);
+    std::string resolved;
+    uint64_t start = rootStart_;
+    uint64_t entry = findContainer(start);
+    uint64_t end = entry ? readU64(entry + 5) : source_.size();
+
+    // Descend through indexed containers; the rest of the pointer is
+    // resolved in the DOM of the value they lead to.
+    size_t t = 0;
+    for (; t < tokens.size() && entry; ++t) {
+        const std::string& token = tokens[t];
+        appendJsonPointer(resolved, token);
+        const unsigned char kind = *bytes(entry, 1);
+        const uint32_t count = readU32(entry + 1);
+        const uint64_t table = entry + kEntryHeader;
+        uint64_t bound = readU64(entry + 5);
+        if (kind == kArray) {
+            long long i = jsonPointerIndex(token);
+            if (i < 0 || static_cast<uint64_t>(i) >= count) throw std::runtime_error("No such path: " + resolved);
+            start = readU64(table + static_cast<uint64_t>(i) * 8);
+            if (static_cast<uint64_t>(i) + 1 < count) bound = readU64(table + (static_cast<uint64_t>(i) + 1) * 8);
+        } else {
+            uint64_t lo = 0, hi = count;
+            while (lo < hi) {
+                uint64_t mid = lo + (hi - lo) / 2;
+                if (keyAt(readU64(table + mid * 16)) < token) lo = mid + 1;
+                else                                          hi = mid;
+            }
+            if (lo == count || keyAt(readU64(table + lo * 16)) != token)
+                throw std::runtime_error("No such path: " + resolved);
+            start = readU64(table + lo * 16 + 8);
+        }
+        entry = findContainer(start);
+        end = entry ? readU64(entry + 5) : valueEnd(start, bound);
+    }
+
+    if (start > end || end > source_.size()) throw std::runtime_error("Corrupt index: " + indexFile_);
+    std::string text = source_.size() ? std::string(source_.data() + start, end - start) : std::string();
+    if (lexemes) {
+        *lexemes = std::move(text);
+        return resolveJsonPointer(JsonLexemeParser::parse(*lexemes, mr), tokens, t, resolved);
+    }
+    return resolveJsonPointer(JsonParser::parse(text, mr), tokens, t, resolved);
+}
@@ -0,0 +1,74 @@
+#ifndef JSONINDEX_H
+#define JSONINDEX_H
+
+#include <cstdint>
+#include <memory>
+#include <memory_resource>
+#include <string>
+#include <string_view>
+#include "jsonbinary.h"
+#include "jsonparser.h"
+
+// Sidecar offset index ("JSFYIDX") for random access into large JSON files.
+//
+// Layout (all integers little-endian, offsets absolute from the start of the
+// index file unless noted):
+//   header    : "JSFYIDX\0" | u32 version | u32 reserved | u64 source size
+//               | i64 source mtime | u64 directory offset | u64 directory count
+//   container : u8 kind (5 array, 6 object) | u32 count | u64 source end
+//     array   : count x u64 element start
+//     object  : count x (u64 key offset, u64 value start), sorted bytewise by
+//               key; keys are u32 length | bytes, unescaped
+//   directory : count x (u64 source start, u64 container offset), by start
+//
+// Starts and ends are byte offsets into the JSON source. The root and every
+// container spanning at least `minContainerBytes` are indexed, so a lookup
+// walks the tables down to a value that is either indexed itself or small,
+// and parses only that value's bytes.
+
+std::string jsonIndexPath(const std::string& sourceFile);   // sourceFile + ".jidx"
+
+struct JsonIndexSummary {
+    uint64_t containers = 0;   // indexed containers
+    uint64_t entries = 0;      // elements and members listed in their tables
+};
+
+// Scans `sourceFile` (strict JSON) without building a DOM and writes the
+// index; throws std::runtime_error on syntax errors like the parser.
+JsonIndexSummary buildJsonIndex(const std::string& sourceFile, const std::string& indexFile,
+                                size_t minContainerBytes = size_t(64) << 10);
+
+// A source file and its index, both memory-mapped.
+class JsonIndex {
+public:
+    JsonIndex(const std::string& sourceFile, const std::string& indexFile);
+
+    // False once the source's size or modification time differs from the
+    // ones recorded when the index was built.
+    bool fresh() const { return fresh_; }
+
+    // The value at a JSON Pointer, parsed from its byte range only. Throws
+    // "No such path: ..." like resolveJsonPointer(). With `lexemes`, the
+    // range is parsed with JsonLexemeParser into *lexemes, which the numbers'
+    // and strings' source text points into and which must outlive the result.
+    std::shared_ptr<JsonValue> query(std::string_view pointer,
+                                     std::pmr::memory_resource* mr = std::pmr::get_default_resource(),
+                                     std::string* lexemes = nullptr) const;
+
+private:
+    const unsigned char* bytes(uint64_t off, uint64_t len) const;
+    uint32_t readU32(uint64_t off) const;
+    uint64_t readU64(uint64_t off) const;
+    std::string_view keyAt(uint64_t off) const;
+    uint64_t findContainer(uint64_t start) const;   // 0 if not indexed
+    uint64_t valueEnd(uint64_t start, uint64_t bound) const;
+
+    std::string    indexFile_;
+    JsonMappedFile source_;
+    JsonMappedFile index_;
+    uint64_t       directory_ = 0, directoryCount_ = 0;
+    uint64_t       rootStart_ = 0;
+    bool           fresh_ = false;
+};
+
+#endif // JSONINDEX_H
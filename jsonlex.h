@@ -0,0 +1,161 @@
+#ifndef JSONLEX_H
+#define JSONLEX_H
+
+#include <array>
+#include <cstdint>
+#include <cstdlib>
+#include <cstring>
+#include <string>
+#include "jsonparser.h"
+
+// Token lexing shared by BasicJsonParser (jsonparser.cpp) and JsonReader
+// (jsonbind.cpp). Each function scans from `p` and advances it. On malformed
+// input it returns the error message, with `p` left at the offending
+// character, and the caller reports it with its own position bookkeeping;
+// nullptr means success.
+namespace json_lex {
+
+// Character classes, looked up instead of the locale-dependent <cctype> calls.
+enum CharClass : unsigned char {
+    kSpace  = 1 << 0,   // JSON whitespace: ' ' \t \n \r
+    kDigit  = 1 << 1,   // 0-9
+    kNumber = 1 << 2,   // anything that may appear in a number token
+    kAlpha  = 1 << 3,   // a-z A-Z
+    kHex    = 1 << 4    // 0-9 a-f A-F
+};
+
+constexpr std::array<unsigned char, 256> makeCharTable() {
+    std::array<unsigned char, 256> t{};
+    t[' '] = t['\t'] = t['\n'] = t['\r'] = kSpace;
+    for (int c = '0'; c <= '9'; ++c) t[c] = kDigit | kNumber | kHex;
+    for (int c = 'a'; c <= 'z'; ++c) t[c] = kAlpha;
+    for (int c = 'A'; c <= 'Z'; ++c) t[c] = kAlpha;
+    for (int c = 'a'; c <= 'f'; ++c) t[c] |= kHex;
+    for (int c = 'A'; c <= 'F'; ++c) t[c] |= kHex;
+    t['.'] |= kNumber; t['e'] |= kNumber; t['E'] |= kNumber;
+    t['+'] |= kNumber; t['-'] |= kNumber;
+    return t;
+}
+
+inline constexpr std::array<unsigned char, 256> kCharTable = makeCharTable();
+
+inline bool hasClass(char c, unsigned char cls) {
+    return (kCharTable[static_cast<unsigned char>(c)] & cls) != 0;
+}
+
+// Returned by stringBody() for a missing closing quote, which callers report
+// at the opening quote rather than at the end of the input.
+inline constexpr char kUnterminatedString[] = "Unterminated string";
+
+// The four hex digits of a \u escape; `p` does not move on failure.
+inline const char* hex4(const char*& p, const char* end, uint32_t& cp) {
+    if (end - p < 4) return "Incomplete Unicode escape";
+    cp = 0;
+    for (int i = 0; i < 4; ++i) {
+        char h = p[i];
+        if (!hasClass(h, kHex)) return "Incomplete Unicode escape";
+        cp = (cp << 4) | static_cast<uint32_t>(hasClass(h, kDigit) ? h - '0' : (h | 0x20) - 'a' + 10);
+    }
+    p += 4;
+    return nullptr;
+}
+
+// A number in the strict grammar
+//   -?(0|[1-9][0-9]*)(\.[0-9]+)?([eE][+-]?[0-9]+)?
+// `integer` is set when it has neither a fraction nor an exponent.
+inline const char* strictNumber(const char*& p, const char* end, bool& integer) {
+    auto digits = [&]() {
+        const char* d = p;
+        while (p != end && hasClass(*p, kDigit)) ++p;
+        return p != d;
+    };
+    integer = true;
+    if (p != end && *p == '-') ++p;
+    if (p != end && *p == '0') ++p;
+    else if (!digits()) return "Number without digits";
+    if (p != end && *p == '.') {
+        ++p; integer = false;
+        if (!digits()) return "Invalid number format";
+    }
+    if (p != end && (*p == 'e' || *p == 'E')) {
+        ++p; integer = false;
+        if (p != end && (*p == '+' || *p == '-')) ++p;
+        if (!digits()) return "Invalid number format";
+    }
+    return nullptr;
+}
+
+// strtod over [start, end), which needs a terminated copy; ordinary numbers
+// stay off the heap. False unless the whole token converts.
+inline bool toDouble(const char* start, const char* end, double& out) {
+    size_t len = static_cast<size_t>(end - start);
+    char small[64];
+    std::string large;
+    const char* num = small;
+    if (len < sizeof small) {
+        std::memcpy(small, start, len);
+        small[len] = '\0';
+    } else {
+        large.assign(start, end);
+        num = large.c_str();
+    }
+    char* stop = nullptr;
+    out = std::strtod(num, &stop);
+    return stop == num + len;
+}
+
+// The rest of a string whose opening quote `p` has just passed, decoded and
+// appended to `out`; `p` ends after the closing quote. With RejectControl,
+// raw control characters are errors as strict JSON requires.
+template <bool RejectControl, class Out>
+const char* stringBody(const char*& p, const char* end, Out& out) {
+    while (p != end) {
+        // copy the run of plain characters in one go
+        const char* run = p;
+        while (p != end && *p != '"' && *p != '\\') {
+            if constexpr (RejectControl) {
+                if (static_cast<unsigned char>(*p) < 0x20) return "Unescaped control character in string";
+            }
+            ++p;
+        }
+        out.append(run, p);
+        if (p == end) break;
+
+        char c = *p++;
+        if (c == '"') return nullptr;
+
+        // backslash
+        if (p == end) return "Unterminated escape sequence";
+        c = *p++;
+        switch (c) {
+            case '"': case '\\': case '/': out += c; break;
+            case 'b': out += '\b'; break;
+            case 'f': out += '\f'; break;
+            case 'n': out += '\n'; break;
+            case 'r': out += '\r'; break;
+            case 't': out += '\t'; break;
+            case 'u': {
+                uint32_t cp;
+                if (const char* err = hex4(p, end, cp)) return err;
+                if (cp >= 0xD800 && cp <= 0xDBFF && end - p >= 6 && p[0] == '\\' && p[1] == 'u') {
+                    const char* low = p;
+                    p += 2;
+                    uint32_t lo;
+                    if (const char* err = hex4(p, end, lo)) return err;
+                    if (lo >= 0xDC00 && lo <= 0xDFFF)
+                        cp = 0x10000 + ((cp - 0xD800) << 10) + (lo - 0xDC00);
+                    else
+                        p = low;   // lone high surrogate, re-read the next escape
+                }
+                out += decodeUnicode(cp);
+                break;
+            }
+            default: --p; return "Invalid escape sequence";
+        }
+    }
+    return kUnterminatedString;
+}
+
+} // namespace json_lex
+
+#endif // JSONLEX_H
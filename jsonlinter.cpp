@@ -1,5 +1,6 @@
 #include "jsonlinter.h"
 #include <unordered_set>
+#include <string_view>
 #include <cmath>
 
 static void lintNumber(const std::shared_ptr<JsonValue>& v,
@@ -31,13 +32,13 @@ static void lintRec(const std::shared_ptr<JsonValue>& node,
     lintNumber(node, src, issues);
 
     if (node->getType() == JsonValue::Type::Object) {
-        std::unordered_set<std::string> seen;
+        std::unordered_set<std::string_view> seen;
         for (const auto& kv : node->getObject()) {
             if (kv.first.empty()) {
                 issues.push_back({JsonLintIssue::Severity::Warning,
                                   "Empty key detected in object.", -1, -1});
             }
-            auto isCamelCase = [](const std::string& key) {
+            auto isCamelCase = [](const JsonString& key) {
                 for (size_t i = 0; i < key.size(); ++i) {
                     char c = key[i];
                     if (i == 0 && !std::islower(c)) return false;
@@ -48,11 +49,11 @@ static void lintRec(const std::shared_ptr<JsonValue>& node,
             };
             if (!kv.first.empty() && !isCamelCase(kv.first)) {
                 issues.push_back({JsonLintIssue::Severity::Warning,
-                                  "Key does not follow camelCase: " + kv.first, -1, -1});
+                                  "Key does not follow camelCase: " + std::string(kv.first), -1, -1});
             }
             if (!seen.insert(kv.first).second) {
                 issues.push_back({JsonLintIssue::Severity::Warning,
-                                  "Duplicate key: " + kv.first, -1, -1});
+                                  "Duplicate key: " + std::string(kv.first), -1, -1});
             }
             lintRec(kv.second, src, issues, depth + 1);
         }
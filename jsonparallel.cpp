@@ -0,0 +1,284 @@
+#include "jsonparallel.h"
+#include "jsonformatter.h"
+#include "threadpool.h"
+#include <algorithm>
+#include <deque>
+#include <mutex>
+#include <sstream>
+#include <vector>
+
+namespace {
+
+// Top-level layout of a container document found by scanSplits().
+struct Splits {
+    char   open = 0;                 // '[' or '{'
+    size_t bodyBegin = 0;            // first byte after the opening bracket
+    size_t bodyEnd = 0;              // index of the matching closing bracket
+    std::vector<size_t> commas;      // chosen top-level commas, ascending
+};
+
+inline bool isSpace(char c) { return c == ' ' || c == '\t' || c == '\n' || c == '\r'; }
+
+// Skips whitespace (and comments when allowed). Returns false on a malformed comment.
+bool skipBlank(const std::string& s, size_t& i, bool comments) {
+    while (i < s.size()) {
+        if (isSpace(s[i])) { ++i; continue; }
+        if (comments && s[i] == '/' && i + 1 < s.size()) {
+            if (s[i+1] == '/') {
+                size_t nl = s.find('\n', i + 2);
+                i = (nl == std::string::npos) ? s.size() : nl + 1;
+                continue;
+            }
+            if (s[i+1] == '*') {
+                size_t close = s.find("*/", i + 2);
+                if (close == std::string::npos) return false;
+                i = close + 2;
+                continue;
+            }
+        }
+        break;
+    }
+    return true;
+}
+
+// One pass over the document tracking strings and nesting depth. Picks the
+// first top-level comma after every `chunk` bytes. Returns false if the
+// document is not a single well-bracketed container.
+bool scanSplits(const std::string& s, bool comments, size_t chunk, Splits& out) {
+    size_t i = 0;
+    if (!skipBlank(s, i, comments) || i == s.size()) return false;
+    if (s[i] != '[' && s[i] != '{') return false;
+    out.open = s[i];
+    out.bodyBegin = ++i;
+
+    const char* data = s.data();
+    const size_t n = s.size();
+    size_t depth = 1;
+    size_t nextCut = i + chunk;
+    while (i < n) {
+        char c = data[i];
+        if (c == '"') {
+            // jump to the closing quote, honouring backslash escapes
+            for (++i; i < n && data[i] != '"'; ++i) {
+                if (data[i] == '\\') ++i;
+            }
+            if (i >= n) return false;
+            ++i;
+            continue;
+        }
+        if (comments && c == '/') {
+            size_t j = i;
+            if (!skipBlank(s, j, true)) return false;
+            if (j != i) { i = j; continue; }
+        }
+        switch (c) {
+            case '[': case '{': ++depth; break;
+            case ']': case '}':
+                if (--depth == 0) {
+                    out.bodyEnd = i++;
+                    return skipBlank(s, i, comments) && i == n;
+                }
+                break;
+            case ',':
+                if (depth == 1 && i >= nextCut) {
+                    out.commas.push_back(i);
+                    nextCut = i + chunk;
+                }
+                break;
+            default: break;
+        }
+        ++i;
+    }
+    return false;
+}
+
+// Serialises the chunk arenas' block requests to a resource that need not
+// be thread-safe, such as the caller's monotonic arena.
+class LockedResource : public std::pmr::memory_resource {
+public:
+    explicit LockedResource(std::pmr::memory_resource* upstream) : upstream_(upstream) {}
+
+private:
+    void* do_allocate(size_t bytes, size_t align) override {
+        std::lock_guard<std::mutex> lock(m_);
+        return upstream_->allocate(bytes, align);
+    }
+    void do_deallocate(void* p, size_t bytes, size_t align) override {
+        std::lock_guard<std::mutex> lock(m_);
+        upstream_->deallocate(p, bytes, align);
+    }
+    bool do_is_equal(const std::pmr::memory_resource& other) const noexcept override {
+        return this == &other;
+    }
+
+    std::pmr::memory_resource* upstream_;
+    std::mutex m_;
+};
+
+// What a parallel parse result owns besides its nodes: one arena per chunk.
+// The root is declared last so that the tree goes before the arenas.
+struct ChunkArenas {
+    LockedResource upstream;
+    std::pmr::deque<std::pmr::monotonic_buffer_resource> arenas;   // never relocated
+    std::shared_ptr<JsonValue> root;
+
+    explicit ChunkArenas(std::pmr::memory_resource* mr) : upstream(mr), arenas(mr) {}
+};
+
+} // namespace
+
+/* --------------------------------------------------------------- */
+template <class Parser>
+std::shared_ptr<JsonValue> parseParallel(const std::string& json, ThreadPool& pool,
+                                         size_t minChunkBytes, std::pmr::memory_resource* mr) {
+    if (pool.size() < 2 || json.size() < 2 * minChunkBytes) return Parser::parse(json, mr);
+
+    size_t chunk = std::max(minChunkBytes, json.size() / (pool.size() * 4));
+    Splits sp;
+    if (!scanSplits(json, Parser::options::allowComments, chunk, sp) || sp.commas.empty())
+        return Parser::parse(json, mr);
+
+    // chunk k covers [bounds[k], bounds[k+1]) minus the separating comma
+    std::vector<size_t> begins{sp.bodyBegin}, ends;
+    for (size_t comma : sp.commas) { ends.push_back(comma); begins.push_back(comma + 1); }
+    ends.push_back(sp.bodyEnd);
+    const size_t parts = begins.size();
+
+    auto owner = std::allocate_shared<ChunkArenas>(std::pmr::polymorphic_allocator<ChunkArenas>(mr), mr);
+    for (size_t k = 0; k < parts; ++k)
+        owner->arenas.emplace_back(ends[k] - begins[k], &owner->upstream);
+
+    try {
+        TaskGroup group(pool);
+        if (sp.open == '[') {
+            std::vector<JsonArray> pieces;
+            pieces.reserve(parts);
+            for (size_t k = 0; k < parts; ++k) pieces.emplace_back(&owner->arenas[k]);
+            for (size_t k = 0; k < parts; ++k)
+                group.run([&, k] { Parser::parseElements(json, begins[k], ends[k], pieces[k]); });
+            group.wait();
+
+            size_t total = 0;
+            for (const auto& p : pieces) total += p.size();
+            JsonArray arr(mr);
+            arr.reserve(total);
+            for (auto& p : pieces)
+                std::move(p.begin(), p.end(), std::back_inserter(arr));
+            owner->root = makeJsonValue(mr, std::move(arr));
+        } else {
+            std::vector<JsonMembers> pieces;
+            pieces.reserve(parts);
+            for (size_t k = 0; k < parts; ++k) pieces.emplace_back(&owner->arenas[k]);
+            for (size_t k = 0; k < parts; ++k)
+                group.run([&, k] { Parser::parseMembers(json, begins[k], ends[k], pieces[k]); });
+            group.wait();
+
+            // Insert in document order, without reserving, so the map (including
+            // its iteration order) ends up exactly as the sequential parser's.
+            JsonObject obj(mr);
+            for (auto& piece : pieces) {
+                for (auto& kv : piece) {
+                    if constexpr (Parser::options::rejectDuplicateKeys) {
+                        if (obj.count(kv.first)) return Parser::parse(json, mr);
+                    }
+                    obj[std::move(kv.first)] = std::move(kv.second);
+                }
+            }
+            owner->root = makeJsonValue(mr, std::move(obj));
+        }
+    } catch (const std::exception&) {
+        // Let the sequential parser decide: it either accepts a lenient
+        // construct the chunks could not, or reports the first error exactly.
+        return Parser::parse(json, mr);
+    }
+    JsonValue* root = owner->root.get();
+    return std::shared_ptr<JsonValue>(std::move(owner), root);
+}
+
+/* --------------------------------------------------------------- */
+namespace {
+
+bool isLargeContainer(const std::shared_ptr<JsonValue>& v, size_t minChildren) {
+    if (!v) return false;
+    if (v->getType() == JsonValue::Type::Array)  return v->getArray().size()  >= 2 * minChildren;
+    if (v->getType() == JsonValue::Type::Object) return v->getObject().size() >= 2 * minChildren;
+    return false;
+}
+
+} // namespace
+
+void printJsonParallel(const std::shared_ptr<JsonValue>& value,
+                       std::ostream& os,
+                       ThreadPool& pool,
+                       int indent, int indentStep, bool compact, bool useColor,
+                       size_t minChildren) {
+    if (pool.size() < 2 || !isLargeContainer(value, minChildren)) {
+        printJson(value, os, indent, indentStep, compact, useColor);
+        return;
+    }
+
+    // Members in printJson's iteration order; keys stay null for arrays.
+    struct Item {
+        const JsonString* key;
+        const std::shared_ptr<JsonValue>* value;
+    };
+    std::vector<Item> items;
+    const bool isArray = value->getType() == JsonValue::Type::Array;
+    if (isArray) {
+        const auto& a = value->getArray();
+        items.reserve(a.size());
+        for (const auto& el : a) items.push_back({nullptr, &el});
+    } else {
+        const auto& o = value->getObject();
+        items.reserve(o.size());
+        for (const auto& kv : o) items.push_back({&kv.first, &kv.second});
+    }
+
+    const size_t n = items.size();
+    const size_t parts = std::min(pool.size() * 4, n / minChildren);
+    std::vector<std::string> buffers(parts);
+
+    TaskGroup group(pool);
+    for (size_t k = 0; k < parts; ++k) {
+        group.run([&, k] {
+            size_t first = n * k / parts, last = n * (k + 1) / parts;
+            std::ostringstream buf;
+            for (size_t i = first; i < last; ++i) {
+                printJsonItemPrefix(buf, items[i].key, indent, indentStep, compact, useColor);
+                // nested large containers are split in turn
+                printJsonParallel(*items[i].value, buf, pool, indent + indentStep,
+                                  indentStep, compact, useColor, minChildren);
+                printJsonItemSuffix(buf, i + 1 == n, compact);
+            }
+            buffers[k] = buf.str();
+        });
+    }
+    group.wait();
+
+    os << (isArray ? '[' : '{');
+    if (!compact) os << '\n';
+    for (const auto& b : buffers) os.write(b.data(), static_cast<std::streamsize>(b.size()));
+    if (!compact) printIndent(os, indent);
+    os << (isArray ? ']' : '}');
+}
+
+/* --------------------------------------------------------------- */
+#define JSONIFY_INSTANTIATE_PARALLEL(T, C, S, D, K) \
+    template std::shared_ptr<JsonValue> \
+    parseParallel<BasicJsonParser<JsonParseOptions<T, C, S, D, K>>>(const std::string&, ThreadPool&, size_t, \
+                                                                      std::pmr::memory_resource*);
+#define JSONIFY_INSTANTIATE_PARALLEL_K(T, C, S, D) \
+    JSONIFY_INSTANTIATE_PARALLEL(T, C, S, D, false) JSONIFY_INSTANTIATE_PARALLEL(T, C, S, D, true)
+#define JSONIFY_INSTANTIATE_PARALLEL_D(T, C, S) \
+    JSONIFY_INSTANTIATE_PARALLEL_K(T, C, S, false) JSONIFY_INSTANTIATE_PARALLEL_K(T, C, S, true)
+#define JSONIFY_INSTANTIATE_PARALLEL_S(T, C) \
+    JSONIFY_INSTANTIATE_PARALLEL_D(T, C, false) JSONIFY_INSTANTIATE_PARALLEL_D(T, C, true)
+#define JSONIFY_INSTANTIATE_PARALLEL_C(T) \
+    JSONIFY_INSTANTIATE_PARALLEL_S(T, false) JSONIFY_INSTANTIATE_PARALLEL_S(T, true)
+JSONIFY_INSTANTIATE_PARALLEL_C(false)
+JSONIFY_INSTANTIATE_PARALLEL_C(true)
+#undef JSONIFY_INSTANTIATE_PARALLEL_C
+#undef JSONIFY_INSTANTIATE_PARALLEL_S
+#undef JSONIFY_INSTANTIATE_PARALLEL_D
+#undef JSONIFY_INSTANTIATE_PARALLEL_K
+#undef JSONIFY_INSTANTIATE_PARALLEL
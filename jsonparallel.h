@@ -0,0 +1,39 @@
+#ifndef JSONPARALLEL_H
+#define JSONPARALLEL_H
+
+#include <memory>
+#include <memory_resource>
+#include <ostream>
+#include <string>
+#include "jsonparser.h"
+
+class ThreadPool;
+
+// Parse a document whose root is a large array or object on several threads.
+// A quote-aware structural scan picks top-level commas as split points, the
+// chunks are parsed concurrently and stitched back together in order. The
+// result is identical to Parser::parse(): small inputs, non-container roots
+// and anything the chunked path rejects are handed to the sequential parser,
+// so errors carry the same message and position. Everything is allocated
+// from `mr`, which must outlive the tree like with Parser::parse(): each chunk
+// parses into its own arena that draws blocks from `mr` under a lock, and the
+// root owns the arenas, so no node may be kept after the root is dropped.
+template <class Parser>
+std::shared_ptr<JsonValue> parseParallel(const std::string& json, ThreadPool& pool,
+                                         size_t minChunkBytes = size_t(1) << 20,
+                                         std::pmr::memory_resource* mr = std::pmr::get_default_resource());
+
+// printJson() for large documents: the members of every array/object with at
+// least 2 * minChildren members are rendered on the pool into separate buffers
+// (each member's indentation is known up front) and written out in order.
+// The output is byte-identical to printJson().
+void printJsonParallel(const std::shared_ptr<JsonValue>& value,
+                       std::ostream& os,
+                       ThreadPool& pool,
+                       int indent = 0,
+                       int indentStep = 2,
+                       bool compact = false,
+                       bool useColor = false,
+                       size_t minChildren = 4096);
+
+#endif
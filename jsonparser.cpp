@@ -1,15 +1,21 @@
 #include "jsonparser.h"
-#include <cctype>
+#include "jsonlex.h"
 #include <cstdint>
-#include <iomanip>
+#include <cstdlib>
+#include <cstring>
 #include <sstream>
 
 JsonValue::JsonValue() : type_(Type::Null) {}
 JsonValue::JsonValue(bool v)       : type_(Type::Bool),   value_(v) {}
 JsonValue::JsonValue(double v)     : type_(Type::Number), value_(v) {}
-JsonValue::JsonValue(std::string v): type_(Type::String), value_(std::move(v)) {}
+JsonValue::JsonValue(JsonString v) : type_(Type::String), value_(std::move(v)) {}
+JsonValue::JsonValue(const std::string& v) : type_(Type::String), value_(JsonString(v)) {}
 JsonValue::JsonValue(JsonArray v)  : type_(Type::Array),  value_(std::move(v)) {}
 JsonValue::JsonValue(JsonObject v) : type_(Type::Object), value_(std::move(v)) {}
+JsonValue::JsonValue(double v, std::string_view lexeme)
+    : type_(Type::Number), value_(LexemeNumber{v, lexeme}) {}
+JsonValue::JsonValue(JsonString v, std::string_view lexeme)
+    : type_(Type::String), value_(LexemeString{std::move(v), lexeme}) {}
 
 JsonValue::Type JsonValue::getType()   const { return type_; }
 
@@ -21,15 +27,21 @@ bool JsonValue::getBool()   const {
 }
 
 double JsonValue::getNumber() const {
-    if (std::holds_alternative<bool>(value_)) {
+    if (std::holds_alternative<double>(value_)) {
         return std::get<double>(value_);
     }
+    if (std::holds_alternative<LexemeNumber>(value_)) {
+        return std::get<LexemeNumber>(value_).value;
+    }
     throw std::runtime_error("Cannot retrieve number value, types mismatch");
 }
 
-const std::string& JsonValue::getString() const {
-    if (std::holds_alternative<std::string>(value_)) {
-        return std::get<std::string>(value_);
+const JsonString& JsonValue::getString() const {
+    if (std::holds_alternative<JsonString>(value_)) {
+        return std::get<JsonString>(value_);
+    }
+    if (std::holds_alternative<LexemeString>(value_)) {
+        return std::get<LexemeString>(value_).value;
     }
     throw std::runtime_error("Cannot retrieve string value, types mismatch"); 
 }
@@ -48,8 +60,46 @@ const JsonObject& JsonValue::getObject() const {
     throw std::runtime_error("Cannot retrieve object value, types mismatch");
 }
 
+JsonArray& JsonValue::getArray() {
+    return const_cast<JsonArray&>(static_cast<const JsonValue&>(*this).getArray());
+}
+
+JsonObject& JsonValue::getObject() {
+    return const_cast<JsonObject&>(static_cast<const JsonValue&>(*this).getObject());
+}
+
+std::string_view JsonValue::getLexeme() const {
+    if (auto n = std::get_if<LexemeNumber>(&value_)) return n->lexeme;
+    if (auto s = std::get_if<LexemeString>(&value_)) return s->lexeme;
+    return {};
+}
+
+void JsonValue::setLexeme(std::string_view lexeme) {
+    if (auto n = std::get_if<LexemeNumber>(&value_)) {
+        if (lexeme.empty()) value_ = n->value;
+        else                n->lexeme = lexeme;
+    } else if (auto s = std::get_if<LexemeString>(&value_)) {
+        if (lexeme.empty()) value_ = JsonString(std::move(s->value));
+        else                s->lexeme = lexeme;
+    } else if (lexeme.empty()) {
+        return;
+    } else if (auto d = std::get_if<double>(&value_)) {
+        value_ = LexemeNumber{*d, lexeme};
+    } else if (auto str = std::get_if<JsonString>(&value_)) {
+        value_ = LexemeString{std::move(*str), lexeme};
+    }
+}
+
+/* --------------------------------------------------------------- */
+using json_lex::hasClass;
+using json_lex::kSpace;
+using json_lex::kDigit;
+using json_lex::kNumber;
+using json_lex::kAlpha;
+
 /* --------------------------------------------------------------- */
-JsonParser::Pos JsonParser::currentPos(const std::string& src, size_t idx) {
+template <class Options>
+JsonPos BasicJsonParser<Options>::currentPos(const std::string& src, size_t idx) {
     Pos p{1,1};
     for (size_t i = 0; i < idx && i < src.size(); ++i) {
         if (src[i] == '\n') { ++p.line; p.col = 1; }
@@ -59,196 +109,295 @@ JsonParser::Pos JsonParser::currentPos(const std::string& src, size_t idx) {
 }
 
 /* --------------------------------------------------------------- */
-std::shared_ptr<JsonValue> JsonParser::loadFromFile(const std::string& filename) {
+template <class Options>
+std::shared_ptr<JsonValue> BasicJsonParser<Options>::loadFromFile(const std::string& filename,
+                                                                   std::pmr::memory_resource* mr) {
     std::ifstream f(filename);
     if (!f) throw std::runtime_error("Cannot open file: " + filename);
     std::stringstream buf; buf << f.rdbuf();
-    return parse(buf.str());
+    return parse(buf.str(), mr);
+}
+
+/* --------------------------------------------------------------- */
+template <class Options>
+std::shared_ptr<JsonValue> BasicJsonParser<Options>::parse(const std::string& json,
+                                                           std::pmr::memory_resource* mr) {
+    Cursor cur{json.data(), json.data(), json.data() + json.size(), 1, json.data(), mr, 0};
+    auto root = parseValue(cur);
+    skipWhitespace(cur);
+    if constexpr (Options::strict) {
+        if (cur.p != cur.end) fail(cur, "Unexpected trailing content");
+    }
+    return root;
 }
 
 /* --------------------------------------------------------------- */
-std::shared_ptr<JsonValue> JsonParser::parse(const std::string& json) {
-    std::istringstream is(json);
-    Pos pos{1,1};
-    return parseValue(is, json, pos);
+template <class Options>
+void BasicJsonParser<Options>::parseElements(const std::string& json, size_t first,
+                                             size_t last, JsonArray& out) {
+    Cursor cur{json.data(), json.data() + first, json.data() + last, 1, json.data() + first,
+               out.get_allocator().resource(), 1};
+    while (true) {
+        out.push_back(parseValue(cur));
+        skipWhitespace(cur);
+        if (cur.p == cur.end) return;
+        if (*cur.p != ',') fail(cur, "Expected ',' or ']' in array");
+        ++cur.p;
+    }
 }
 
 /* --------------------------------------------------------------- */
-void JsonParser::skipWhitespace(std::istream& is,
-                                const std::string& src, Pos& pos) {
-    (void)src;
-    while (is.peek() != EOF) {
-        char c = static_cast<char>(is.peek());
-        if (!std::isspace(c)) break;
-        is.get();
-        if (c == '\n') { ++pos.line; pos.col = 1; }
-        else           { ++pos.col; }
+template <class Options>
+void BasicJsonParser<Options>::parseMembers(const std::string& json, size_t first,
+                                            size_t last, JsonMembers& out) {
+    Cursor cur{json.data(), json.data() + first, json.data() + last, 1, json.data() + first,
+               out.get_allocator().resource(), 1};
+    while (true) {
+        skipWhitespace(cur);
+        if (cur.p == cur.end || *cur.p != '"') fail(cur, "Expected '\"' for object key");
+        JsonString key = parseString(cur);
+
+        skipWhitespace(cur);
+        if (cur.p == cur.end || *cur.p != ':') fail(cur, "Expected ':' after key");
+        ++cur.p;
+
+        auto value = parseValue(cur);
+        out.emplace_back(std::move(key), std::move(value));
+
+        skipWhitespace(cur);
+        if (cur.p == cur.end) return;
+        if (*cur.p != ',') fail(cur, "Expected ',' or '}' in object");
+        ++cur.p;
     }
 }
 
 /* --------------------------------------------------------------- */
-std::shared_ptr<JsonValue> JsonParser::parseValue(std::istream& is,
-                                                  const std::string& src,
-                                                  Pos& pos) {
-    skipWhitespace(is, src, pos);
-    if (is.eof()) throw std::runtime_error("Unexpected end of input");
-
-    char c = static_cast<char>(is.get());
-    ++pos.col;
-
-    if (c == '{') return std::make_shared<JsonValue>(parseObject(is, src, pos));
-    if (c == '[') return std::make_shared<JsonValue>(parseArray (is, src, pos));
-    if (c == '"') { is.unget(); return std::make_shared<JsonValue>(parseString(is, src, pos)); }
-    if (c == 't' || c == 'f') { is.unget(); return std::make_shared<JsonValue>(parseBoolean(is, src, pos, c)); }
-    if (c == 'n') { is.unget(); return parseNull(is, src, pos); }
-    if (std::isdigit(c) || c == '-') { is.unget(); return std::make_shared<JsonValue>(parseNumber(is, src, pos)); }
-
-    throw std::runtime_error("Unexpected character '" + std::string(1,c) + "'");
+template <class Options>
+void BasicJsonParser<Options>::fail(const Cursor& cur, const std::string& msg) {
+    if constexpr (Options::trackPositions) {
+        size_t col = static_cast<size_t>(cur.p - cur.lineStart) + 1;
+        throw std::runtime_error(msg + " (line " + std::to_string(cur.line)
+                                 + ", col " + std::to_string(col) + ")");
+    } else {
+        size_t offset = static_cast<size_t>(cur.p - cur.begin);
+        throw std::runtime_error(msg + " (offset " + std::to_string(offset) + ")");
+    }
 }
 
 /* --------------------------------------------------------------- */
-JsonObject JsonParser::parseObject(std::istream& is,
-                                   const std::string& src, Pos& pos) {
-    JsonObject obj;
-    skipWhitespace(is, src, pos);
-    if (is.peek() == '}') { is.get(); ++pos.col; return obj; }
+template <class Options>
+void BasicJsonParser<Options>::skipWhitespace(Cursor& cur) {
+    while (cur.p != cur.end) {
+        char c = *cur.p;
+        if (hasClass(c, kSpace)) {
+            ++cur.p;
+            if constexpr (Options::trackPositions) {
+                if (c == '\n') { ++cur.line; cur.lineStart = cur.p; }
+            }
+            continue;
+        }
+        if constexpr (Options::allowComments) {
+            if (c == '/') { skipComment(cur); continue; }
+        }
+        break;
+    }
+}
+
+/* --------------------------------------------------------------- */
+template <class Options>
+void BasicJsonParser<Options>::skipComment(Cursor& cur) {
+    if (cur.end - cur.p < 2) fail(cur, "Unexpected character '/'");
+    char kind = cur.p[1];
+    if (kind == '/') {
+        cur.p += 2;
+        while (cur.p != cur.end && *cur.p != '\n') ++cur.p;
+        return;
+    }
+    if (kind != '*') fail(cur, "Unexpected character '/'");
+    Cursor start = cur;
+    cur.p += 2;
+    while (cur.p != cur.end) {
+        char c = *cur.p++;
+        if (c == '*' && cur.p != cur.end && *cur.p == '/') { ++cur.p; return; }
+        if constexpr (Options::trackPositions) {
+            if (c == '\n') { ++cur.line; cur.lineStart = cur.p; }
+        }
+    }
+    fail(start, "Unterminated comment");
+}
+
+/* --------------------------------------------------------------- */
+template <class Options>
+std::shared_ptr<JsonValue> BasicJsonParser<Options>::parseValue(Cursor& cur) {
+    skipWhitespace(cur);
+    if (cur.p == cur.end) fail(cur, "Unexpected end of input");
+
+    char c = *cur.p;
+    switch (c) {
+        case '{': case '[': {
+            if (++cur.depth > kMaxDepth) fail(cur, "Nesting too deep");
+            auto v = c == '{' ? makeJsonValue(cur.mr, parseObject(cur)) : makeJsonValue(cur.mr, parseArray(cur));
+            --cur.depth;
+            return v;
+        }
+        case 't': case 'f': return makeJsonValue(cur.mr, parseBoolean(cur));
+        case 'n': parseNull(cur); return makeJsonValue(cur.mr);
+        default: break;
+    }
+
+    const char* start = cur.p;
+    auto lexeme = [&] { return std::string_view(start, static_cast<size_t>(cur.p - start)); };
+    if (c == '"') {
+        JsonString s = parseString(cur);
+        if constexpr (Options::keepLexemes) return makeJsonValue(cur.mr, std::move(s), lexeme());
+        else                                return makeJsonValue(cur.mr, std::move(s));
+    }
+    if (hasClass(c, kDigit) || c == '-') {
+        double d = parseNumber(cur);
+        if constexpr (Options::keepLexemes) return makeJsonValue(cur.mr, d, lexeme());
+        else                                return makeJsonValue(cur.mr, d);
+    }
+    fail(cur, "Unexpected character '" + std::string(1,c) + "'");
+}
+
+/* --------------------------------------------------------------- */
+template <class Options>
+JsonObject BasicJsonParser<Options>::parseObject(Cursor& cur) {
+    ++cur.p;   // '{'
+    JsonObject obj(cur.mr);
+    skipWhitespace(cur);
+    if (cur.p != cur.end && *cur.p == '}') { ++cur.p; return obj; }
 
     while (true) {
-        skipWhitespace(is, src, pos);
-        if (is.peek() != '"')
-            throw std::runtime_error("Expected '\"' for object key");
-        std::string key = parseString(is, src, pos);
-
-        skipWhitespace(is, src, pos);
-        if (is.get() != ':') {
-            Pos p = currentPos(src, int(is.tellg()) - 1);
-            throw std::runtime_error("Expected ':' after key (line "
-                                     + std::to_string(p.line) + ", col " + std::to_string(p.col) + ")");
+        skipWhitespace(cur);
+        if (cur.p == cur.end || *cur.p != '"') {
+            if constexpr (!Options::strict) {
+                if (cur.p != cur.end && *cur.p == '}' && !obj.empty()) { ++cur.p; break; }
+            }
+            fail(cur, "Expected '\"' for object key");
         }
-        ++pos.col;
+        Cursor keyStart = cur;
+        JsonString key = parseString(cur);
 
-        obj[key] = parseValue(is, src, pos);
+        skipWhitespace(cur);
+        if (cur.p == cur.end || *cur.p != ':') fail(cur, "Expected ':' after key");
+        ++cur.p;
+
+        if constexpr (Options::rejectDuplicateKeys) {
+            if (obj.count(key)) fail(keyStart, "Duplicate key: " + std::string(key));
+        }
+        obj[std::move(key)] = parseValue(cur);
 
-        skipWhitespace(is, src, pos);
-        char sep = static_cast<char>(is.get());
-        ++pos.col;
+        skipWhitespace(cur);
+        if (cur.p == cur.end) fail(cur, "Expected ',' or '}' in object");
+        char sep = *cur.p++;
         if (sep == '}') break;
-        if (sep != ',')
-            throw std::runtime_error("Expected ',' or '}' in object");
+        if (sep != ',') { --cur.p; fail(cur, "Expected ',' or '}' in object"); }
     }
     return obj;
 }
 
 /* --------------------------------------------------------------- */
-JsonArray JsonParser::parseArray(std::istream& is,
-                                 const std::string& src, Pos& pos) {
-    JsonArray arr;
-    skipWhitespace(is, src, pos);
-    if (is.peek() == ']') { is.get(); ++pos.col; return arr; }
+template <class Options>
+JsonArray BasicJsonParser<Options>::parseArray(Cursor& cur) {
+    ++cur.p;   // '['
+    JsonArray arr(cur.mr);
+    skipWhitespace(cur);
+    if (cur.p != cur.end && *cur.p == ']') { ++cur.p; return arr; }
 
     while (true) {
-        arr.push_back(parseValue(is, src, pos));
-        skipWhitespace(is, src, pos);
-        char sep = static_cast<char>(is.get());
-        ++pos.col;
+        if constexpr (!Options::strict) {
+            skipWhitespace(cur);
+            if (cur.p != cur.end && *cur.p == ']' && !arr.empty()) { ++cur.p; break; }
+        }
+        arr.push_back(parseValue(cur));
+        skipWhitespace(cur);
+        if (cur.p == cur.end) fail(cur, "Expected ',' or ']' in array");
+        char sep = *cur.p++;
         if (sep == ']') break;
-        if (sep != ',')
-            throw std::runtime_error("Expected ',' or ']' in array");
+        if (sep != ',') { --cur.p; fail(cur, "Expected ',' or ']' in array"); }
     }
     return arr;
 }
 
 /* --------------------------------------------------------------- */
-std::string JsonParser::parseString(std::istream& is,
-                                    const std::string& src, Pos& pos) {
-    (void)src;
-    if (is.get() != '"') throw std::runtime_error("Internal error: parseString called without opening quote");
-    ++pos.col;
-
-    std::string s;
-    char c;
-    while (is.get(c)) {
-        ++pos.col;
-        if (c == '"') return s;
-        if (c == '\\') {
-            if (!is.get(c)) throw std::runtime_error("Unterminated escape sequence");
-            ++pos.col;
-            switch (c) {
-                case '"': case '\\': case '/': s += c; break;
-                case 'b': s += '\b'; break;
-                case 'f': s += '\f'; break;
-                case 'n': s += '\n'; break;
-                case 'r': s += '\r'; break;
-                case 't': s += '\t'; break;
-                case 'u': {
-                    std::string hex(4,' ');
-                    if (is.read(&hex[0],4).gcount() != 4)
-                        throw std::runtime_error("Incomplete Unicode escape");
-                    pos.col += 4;
-                    s += decodeUnicode(hex);
-                    break;
-                }
-                default: throw std::runtime_error("Invalid escape sequence");
-            }
-        } else {
-            s += c;
-        }
-    }
-    throw std::runtime_error("Unterminated string");
+template <class Options>
+JsonString BasicJsonParser<Options>::parseString(Cursor& cur) {
+    Cursor start = cur;
+    ++cur.p;   // opening quote
+    JsonString s(cur.mr);
+    if (const char* err = json_lex::stringBody<Options::strict>(cur.p, cur.end, s))
+        fail(err == json_lex::kUnterminatedString ? start : cur, err);
+    return s;
 }
 
 /* --------------------------------------------------------------- */
-bool JsonParser::parseBoolean(std::istream& is,
-                              const std::string& src, Pos& pos, char first) {
-    (void)src;
-    std::string token{first};
-    char c;
-    while (std::isalpha(is.peek())) {
-        is.get(c); token += c; ++pos.col;
-    }
-    if (token == "true")  return true;
-    if (token == "false") return false;
-    throw std::runtime_error("Invalid boolean: " + token);
+template <class Options>
+bool BasicJsonParser<Options>::parseBoolean(Cursor& cur) {
+    const char* start = cur.p;
+    while (cur.p != cur.end && hasClass(*cur.p, kAlpha)) ++cur.p;
+    size_t len = static_cast<size_t>(cur.p - start);
+    if (len == 4 && std::memcmp(start, "true", 4) == 0)  return true;
+    if (len == 5 && std::memcmp(start, "false", 5) == 0) return false;
+    std::string token(start, len);
+    cur.p = start;
+    fail(cur, "Invalid boolean: " + token);
 }
 
 /* --------------------------------------------------------------- */
-std::shared_ptr<JsonValue> JsonParser::parseNull(std::istream& is,
-                                                 const std::string& src, Pos& pos) {
-    (void)src;
-    std::string lit = "null";
-    for (char expected : lit.substr(1)) {
-        if (is.get() != expected) throw std::runtime_error("Invalid null");
-        ++pos.col;
-    }
-    return std::make_shared<JsonValue>();
+template <class Options>
+void BasicJsonParser<Options>::parseNull(Cursor& cur) {
+    if (cur.end - cur.p < 4 || std::memcmp(cur.p, "null", 4) != 0
+        || (cur.end - cur.p > 4 && hasClass(cur.p[4], kAlpha)))
+        fail(cur, "Invalid null");
+    cur.p += 4;
 }
 
 /* --------------------------------------------------------------- */
-double JsonParser::parseNumber(std::istream& is,
-                               const std::string& src, Pos& pos) {
-    (void)src;
-    std::string num;
-    bool hasDigit = false;
-    while (is.peek() != EOF) {
-        char c = static_cast<char>(is.peek());
-        if (! (std::isdigit(c) || c=='.' || c=='e' || c=='E' || c=='+' || c=='-')) break;
-        is.get(); num += c; ++pos.col;
-        if (std::isdigit(c)) hasDigit = true;
+template <class Options>
+double BasicJsonParser<Options>::parseNumber(Cursor& cur) {
+    const char* start = cur.p;
+    const char* p = cur.p;
+    const char* end = cur.p;
+    bool simple = true;          // plain integer that fits a double exactly
+
+    if constexpr (Options::strict) {
+        if (const char* err = json_lex::strictNumber(p, cur.end, simple)) { cur.p = p; fail(cur, err); }
+        end = p;
+    } else {
+        bool hasDigit = false;
+        while (p != cur.end && hasClass(*p, kNumber)) {
+            if (!hasClass(*p, kDigit) && *p != '-') simple = false;
+            if (hasClass(*p, kDigit)) hasDigit = true;
+            ++p;
+        }
+        if (!hasDigit) fail(cur, "Number without digits");
+        end = p;
     }
-    if (!hasDigit) throw std::runtime_error("Number without digits");
-    try {
-        size_t idx;
-        double d = std::stod(num, &idx);
-        if (idx != num.size()) throw std::runtime_error("Trailing junk in number");
-        return d;
-    } catch (...) {
-        throw std::runtime_error("Invalid number format");
+
+    // Fast path: up to 15 significant digits convert exactly without strtod.
+    size_t len = static_cast<size_t>(end - start);
+    bool neg = *start == '-';
+    if (simple && len - neg <= 15 && len > size_t(neg)) {
+        int64_t v = 0;
+        for (const char* d = start + neg; d != end; ++d) {
+            if (!hasClass(*d, kDigit)) { simple = false; break; }
+            v = v * 10 + (*d - '0');
+        }
+        if (simple) {
+            cur.p = end;
+            return neg ? -static_cast<double>(v) : static_cast<double>(v);
+        }
     }
+
+    double d;
+    if (!json_lex::toDouble(start, end, d)) fail(cur, "Invalid number format");
+    cur.p = end;
+    return d;
 }
 
 /* --------------------------------------------------------------- */
-std::string JsonParser::decodeUnicode(const std::string& hex) {
-    uint32_t cp = static_cast<uint32_t>(std::stoul(hex, nullptr, 16));
+std::string decodeUnicode(uint32_t cp) {
     std::string utf8;
     if (cp <= 0x7F) {
         utf8 += static_cast<char>(cp);
@@ -271,12 +420,42 @@ std::string JsonParser::decodeUnicode(const std::string& hex) {
 }
 
 /* --------------------------------------------------------------- */
-std::string correctJson(const std::string& json) {
+// Every option combination is instantiated here so each gets its own
+// specialised parser without exposing the implementation in the header.
+#define JSONIFY_INSTANTIATE_PARSER(T, C, S, D, K) \
+    template class BasicJsonParser<JsonParseOptions<T, C, S, D, K>>;
+#define JSONIFY_INSTANTIATE_PARSER_K(T, C, S, D) \
+    JSONIFY_INSTANTIATE_PARSER(T, C, S, D, false) JSONIFY_INSTANTIATE_PARSER(T, C, S, D, true)
+#define JSONIFY_INSTANTIATE_PARSER_D(T, C, S) \
+    JSONIFY_INSTANTIATE_PARSER_K(T, C, S, false) JSONIFY_INSTANTIATE_PARSER_K(T, C, S, true)
+#define JSONIFY_INSTANTIATE_PARSER_S(T, C) \
+    JSONIFY_INSTANTIATE_PARSER_D(T, C, false) JSONIFY_INSTANTIATE_PARSER_D(T, C, true)
+#define JSONIFY_INSTANTIATE_PARSER_C(T) \
+    JSONIFY_INSTANTIATE_PARSER_S(T, false) JSONIFY_INSTANTIATE_PARSER_S(T, true)
+JSONIFY_INSTANTIATE_PARSER_C(false)
+JSONIFY_INSTANTIATE_PARSER_C(true)
+#undef JSONIFY_INSTANTIATE_PARSER_C
+#undef JSONIFY_INSTANTIATE_PARSER_S
+#undef JSONIFY_INSTANTIATE_PARSER_D
+#undef JSONIFY_INSTANTIATE_PARSER_K
+#undef JSONIFY_INSTANTIATE_PARSER
+
+/* --------------------------------------------------------------- */
+std::string correctJson(const std::string& json, bool allowComments) {
     std::string out;
     bool inStr = false, esc = false;
     for (size_t i = 0; i < json.size(); ++i) {
         char c = json[i];
         if (esc) { out += c; esc = false; continue; }
+        if (allowComments && !inStr && c == '/' && i + 1 < json.size()
+            && (json[i + 1] == '/' || json[i + 1] == '*')) {
+            const bool line = json[i + 1] == '/';
+            size_t end = line ? json.find('\n', i + 2) : json.find("*/", i + 2);
+            end = end == std::string::npos ? json.size() : (line ? end : end + 2);
+            out.append(json, i, end - i);
+            i = end - 1;
+            continue;
+        }
         if (c == '\\') { esc = true; out += c; continue; }
         if (c == '"' && !esc) { inStr = !inStr; }
         out += c;
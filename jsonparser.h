@@ -1,6 +1,7 @@
 #ifndef JSONPARSER_H
 #define JSONPARSER_H
 
+#include <cstdint>
 #include <fstream>
 #include <iostream>
 #include <string>
@@ -8,15 +9,30 @@
 #include <vector>
 #include <variant>
 #include <memory>
+#include <memory_resource>
 #include <stdexcept>
+#include <string_view>
 
 class JsonValue;
 
-using JsonObject = std::unordered_map<std::string, std::shared_ptr<JsonValue>>;
-using JsonArray  = std::vector<std::shared_ptr<JsonValue>>;
+// DOM storage uses polymorphic allocators so a whole document can live in a
+// caller-supplied std::pmr::memory_resource (e.g. a per-request monotonic
+// buffer). With the default resource this is ordinary new/delete.
+using JsonString = std::pmr::string;
+using JsonObject = std::pmr::unordered_map<JsonString, std::shared_ptr<JsonValue>>;
+using JsonArray  = std::pmr::vector<std::shared_ptr<JsonValue>>;
+using JsonMembers = std::pmr::vector<std::pair<JsonString, std::shared_ptr<JsonValue>>>; // in document order
 
 class JsonValue {
-    using ValueContainer = std::variant<std::monostate, bool, double, std::string, JsonArray, JsonObject>;
+    // Numbers and strings parsed with KeepLexemes also hold their source
+    // text. These alternatives are no larger than JsonObject, so values
+    // without a lexeme do not pay for it.
+    struct LexemeNumber { double value; std::string_view lexeme; };
+    struct LexemeString { JsonString value; std::string_view lexeme; };
+    using ValueContainer = std::variant<std::monostate, bool, double, JsonString, JsonArray, JsonObject,
+                                        LexemeNumber, LexemeString>;
+    static_assert(sizeof(LexemeString) <= sizeof(JsonObject) && sizeof(LexemeNumber) <= sizeof(JsonObject),
+                  "a lexeme must not make every JsonValue larger");
 
 public:
     enum class Type { Null, Bool, Number, String, Array, Object };
@@ -24,56 +40,139 @@ public:
     JsonValue();
     explicit JsonValue(bool v);
     explicit JsonValue(double v);
-    explicit JsonValue(std::string v);
+    explicit JsonValue(JsonString v);
+    explicit JsonValue(const std::string& v);
     explicit JsonValue(JsonArray v);
     explicit JsonValue(JsonObject v);
+    JsonValue(double v, std::string_view lexeme);
+    JsonValue(JsonString v, std::string_view lexeme);
 
     Type               getType()   const;
     bool               getBool()   const;
     double             getNumber() const;
-    const std::string& getString() const;
+    const JsonString&  getString() const;
     const JsonArray&   getArray()  const;
     const JsonObject&  getObject() const;
 
+    // Mutable access for in-place edits (see jsonpatch.h). New members and
+    // elements should be allocated from the container's memory resource.
+    JsonArray&         getArray();
+    JsonObject&        getObject();
+
+    // Source text of a number or string (quotes and escapes included) when
+    // parsed with KeepLexemes; empty otherwise. Points into the parser input.
+    // Setting it on any other type is ignored; an empty one removes it.
+    std::string_view   getLexeme() const;
+    void               setLexeme(std::string_view lexeme);
+
 private:
     Type        type_;
     ValueContainer value_;
 };
 
-class JsonParser {
+// Allocates a JsonValue, together with its shared_ptr control block, from `mr`.
+template <class... Args>
+std::shared_ptr<JsonValue> makeJsonValue(std::pmr::memory_resource* mr, Args&&... args) {
+    return std::allocate_shared<JsonValue>(std::pmr::polymorphic_allocator<JsonValue>(mr),
+                                           std::forward<Args>(args)...);
+}
+
+// line/column of a byte offset in the source text
+struct JsonPos {
+    size_t line = 1;
+    size_t col = 1;
+    JsonPos() = default;
+    JsonPos(size_t l, size_t c) : line(l), col(c) {}
+};
+
+// Compile-time parser options. Every combination is its own instantiation of
+// BasicJsonParser, so a feature that is switched off is not in the hot loop.
+//   TrackPositions      - keep line/column bookkeeping for error messages
+//                         (otherwise errors report a byte offset)
+//   AllowComments       - accept // and /* */ comments (JSONC)
+//   Strict              - RFC 8259 only; lenient mode allows trailing commas,
+//                         trailing content and loosely formed numbers
+//   RejectDuplicateKeys - throw on a repeated key instead of keeping the last
+//   KeepLexemes         - record each number's and string's source text
+//                         (JsonValue::getLexeme) so printJson can copy it
+//                         verbatim; the input must then outlive the tree.
+//                         Strict mode only: lenient lexemes need not be JSON
+template <bool TrackPositions = true, bool AllowComments = false,
+          bool Strict = true, bool RejectDuplicateKeys = false, bool KeepLexemes = false>
+struct JsonParseOptions {
+    static constexpr bool trackPositions      = TrackPositions;
+    static constexpr bool allowComments       = AllowComments;
+    static constexpr bool strict              = Strict;
+    static constexpr bool rejectDuplicateKeys = RejectDuplicateKeys;
+    static constexpr bool keepLexemes         = KeepLexemes && Strict;
+};
+
+using JsonDefaultOptions = JsonParseOptions<>;
+using JsoncOptions       = JsonParseOptions<true, true>;
+using JsonLexemeOptions  = JsonParseOptions<true, false, true, false, true>;
+using JsoncLexemeOptions = JsonParseOptions<true, true, true, false, true>;
+
+template <class Options>
+class BasicJsonParser {
 public:
-    static std::shared_ptr<JsonValue> parse(const std::string& json);
-    static std::shared_ptr<JsonValue> loadFromFile(const std::string& filename);
+    using options = Options;
+
+    // Arrays and objects nested deeper than this are rejected, so hostile
+    // input cannot exhaust the stack of the recursive descent.
+    static constexpr unsigned kMaxDepth = 4096;
+
+    // Every node, string and container of the result is allocated from `mr`,
+    // which must outlive the returned tree.
+    static std::shared_ptr<JsonValue> parse(const std::string& json,
+                                            std::pmr::memory_resource* mr = std::pmr::get_default_resource());
+    static std::shared_ptr<JsonValue> loadFromFile(const std::string& filename,
+                                                   std::pmr::memory_resource* mr = std::pmr::get_default_resource());
 
     // helpers for line/column tracking
-    struct Pos {
-        size_t line = 1;
-        size_t col = 1;
-        Pos() = default;
-        Pos(size_t l, size_t c) : line(l), col(c) {}
-    };
+    using Pos = JsonPos;
 
     static Pos currentPos(const std::string& src, size_t idx);
 
+    // Parse the comma-separated array elements / object members occupying
+    // exactly json[first, last) and append them to `out`. These are the chunk
+    // entry points of parseParallel() (jsonparallel.h); error positions are
+    // not meaningful and duplicate keys are left to the caller. Values are
+    // allocated from out's memory resource.
+    static void parseElements(const std::string& json, size_t first, size_t last, JsonArray& out);
+    static void parseMembers (const std::string& json, size_t first, size_t last, JsonMembers& out);
+
 private:
-    static void skipWhitespace(std::istream& is, const std::string& src, Pos& pos);
-    static std::shared_ptr<JsonValue> parseValue(std::istream& is,
-                                                 const std::string& src, Pos& pos);
-    static JsonObject parseObject(std::istream& is,
-                                  const std::string& src, Pos& pos);
-    static JsonArray  parseArray (std::istream& is,
-                                  const std::string& src, Pos& pos);
-    static std::string parseString(std::istream& is,
-                                   const std::string& src, Pos& pos);
-    static bool parseBoolean(std::istream& is,
-                             const std::string& src, Pos& pos, char first);
-    static std::shared_ptr<JsonValue> parseNull(std::istream& is,
-                                                const std::string& src, Pos& pos);
-    static double parseNumber(std::istream& is,
-                              const std::string& src, Pos& pos);
-    static std::string decodeUnicode(const std::string& hex);
+    struct Cursor {
+        const char* begin;
+        const char* p;
+        const char* end;
+        size_t      line;       // only maintained when trackPositions
+        const char* lineStart;  // only maintained when trackPositions
+        std::pmr::memory_resource* mr;
+        unsigned    depth;      // open arrays and objects around p
+    };
+
+    [[noreturn]] static void fail(const Cursor& cur, const std::string& msg);
+    static void skipWhitespace(Cursor& cur);
+    static void skipComment(Cursor& cur);
+    static std::shared_ptr<JsonValue> parseValue(Cursor& cur);
+    static JsonObject  parseObject (Cursor& cur);
+    static JsonArray   parseArray  (Cursor& cur);
+    static JsonString  parseString (Cursor& cur);
+    static bool        parseBoolean(Cursor& cur);
+    static void        parseNull   (Cursor& cur);
+    static double      parseNumber (Cursor& cur);
 };
 
-std::string correctJson(const std::string& json);   // simple auto-correction
+using JsonParser  = BasicJsonParser<JsonDefaultOptions>;
+using JsoncParser = BasicJsonParser<JsoncOptions>;
+using JsonLexemeParser  = BasicJsonParser<JsonLexemeOptions>;
+using JsoncLexemeParser = BasicJsonParser<JsoncLexemeOptions>;
+
+std::string decodeUnicode(uint32_t cp);             // code point -> UTF-8
+// Simple auto-correction (missing commas after '}' / ']'). With
+// `allowComments`, // and /* */ comments are copied through untouched, so
+// quotes inside them cannot be mistaken for string delimiters.
+std::string correctJson(const std::string& json, bool allowComments = false);
 
 #endif // JSONPARSER_H
@@ -0,0 +1,597 @@
+#include "jsonpatch.h"
+#include <algorithm>
+#include <map>
+#include <sstream>
+#include <stdexcept>
+#include <utility>
+#include "jsonbind.h"
+#include "jsonformatter.h"
+#include "jsonpointer.h"
+
+using Type = JsonValue::Type;
+
+namespace {
+
+Type typeOf(const std::shared_ptr<JsonValue>& v) { return v ? v->getType() : Type::Null; }
+
+std::string compactText(const std::shared_ptr<JsonValue>& v) {
+    std::ostringstream os;
+    printJson(v, os, 0, 2, true);
+    return os.str();
+}
+
+bool isPrefix(const std::vector<std::string>& prefix, const std::vector<std::string>& tokens) {
+    return prefix.size() <= tokens.size() && std::equal(prefix.begin(), prefix.end(), tokens.begin());
+}
+
+/* ---- In place ---- */
+
+// The container the last token refers into; `resolved` becomes its pointer.
+std::shared_ptr<JsonValue> parentOf(const std::shared_ptr<JsonValue>& root,
+                                    const std::vector<std::string>& tokens, std::string& resolved) {
+    const std::vector<std::string> head(tokens.begin(), tokens.end() - 1);
+    return resolveJsonPointer(root, head, 0, resolved);
+}
+
+// The slot holding an existing value, so that it can be replaced.
+std::shared_ptr<JsonValue>& existing(std::shared_ptr<JsonValue>& root, const std::vector<std::string>& tokens) {
+    if (tokens.empty()) return root;
+    std::string resolved;
+    std::shared_ptr<JsonValue> parent = parentOf(root, tokens, resolved);
+    const std::string& token = tokens.back();
+    appendJsonPointer(resolved, token);
+    if (typeOf(parent) == Type::Object) {
+        JsonObject& o = parent->getObject();
+        auto it = o.find(JsonString(token));
+        if (it != o.end()) return it->second;
+    } else if (typeOf(parent) == Type::Array) {
+        JsonArray& a = parent->getArray();
+        long long i = jsonPointerIndex(token);
+        if (i >= 0 && static_cast<size_t>(i) < a.size()) return a[static_cast<size_t>(i)];
+    }
+    throw std::runtime_error("No such path: " + resolved);
+}
+
+void addValue(std::shared_ptr<JsonValue>& root, const std::vector<std::string>& tokens,
+              std::shared_ptr<JsonValue> value) {
+    if (tokens.empty()) {
+        root = std::move(value);
+        return;
+    }
+    std::string resolved;
+    std::shared_ptr<JsonValue> parent = parentOf(root, tokens, resolved);
+    const std::string& token = tokens.back();
+    appendJsonPointer(resolved, token);
+    if (typeOf(parent) == Type::Object) {
+        parent->getObject().insert_or_assign(JsonString(token), std::move(value));
+        return;
+    }
+    if (typeOf(parent) == Type::Array) {
+        JsonArray& a = parent->getArray();
+        long long i = token == "-" ? static_cast<long long>(a.size()) : jsonPointerIndex(token);
+        if (i >= 0 && static_cast<size_t>(i) <= a.size()) {
+            a.insert(a.begin() + i, std::move(value));
+            return;
+        }
+    }
+    throw std::runtime_error("No such path: " + resolved);
+}
+
+std::shared_ptr<JsonValue> removeValue(std::shared_ptr<JsonValue>& root, const std::vector<std::string>& tokens) {
+    if (tokens.empty()) throw std::runtime_error("Cannot remove the whole document");
+    std::shared_ptr<JsonValue> removed = existing(root, tokens);
+    std::string resolved;
+    std::shared_ptr<JsonValue> parent = parentOf(root, tokens, resolved);
+    if (parent->getType() == Type::Object) parent->getObject().erase(JsonString(tokens.back()));
+    else parent->getArray().erase(parent->getArray().begin() + jsonPointerIndex(tokens.back()));
+    return removed;
+}
+
+/* ---- Streaming ---- */
+
+// What the rewrite does at one path of the document. Nodes without an
+// action of their own only lead to deeper ones, and must exist.
+struct PatchNode {
+    std::map<std::string, PatchNode, std::less<>> children;
+    bool add = false;        // replace, or insert if missing (before the element, in an array)
+    bool replace = false;    // replace an existing value
+    bool remove = false;
+    bool required = false;   // fails if missing (everything but a merge-patch null)
+    bool merge = false;      // merge into an object; replaced by `text` otherwise
+    int  text = -1;          // new value, index into the text table
+    int  capture = -1;       // records the value's source text there (move, copy)
+    std::shared_ptr<JsonValue> test;
+    bool   seen = false;
+    size_t start = 0, end = 0;
+    size_t keyStart = 0, nextStart = 0;   // as an object member: its key, the member after it
+};
+
+// source[begin, end) is replaced by before + text + after.
+struct Splice {
+    size_t begin, end;
+    std::string before;
+    int text;
+    std::string after;
+};
+
+// One pass over the source with JsonReader: only containers on patched
+// paths are walked member by member, everything else is skipped as a
+// whole. Edits are collected as splices and written once the pass has
+// succeeded, so a failing operation writes nothing.
+class PatchStreamer {
+public:
+    explicit PatchStreamer(std::string_view source) : source_(source) {}
+
+    PatchNode& root() { return root_; }
+
+    PatchNode& node(const std::vector<std::string>& tokens) {
+        PatchNode* n = &root_;
+        for (const auto& t : tokens) n = &n->children[t];
+        return *n;
+    }
+
+    int addText(std::string text) {
+        texts_.push_back(std::move(text));
+        return static_cast<int>(texts_.size() - 1);
+    }
+
+    void run(std::ostream& out) {
+        JsonReader in(source_);
+        std::string path;
+        in.peek();
+        value(in, root_, path);
+        in.finish();
+        for (const auto& t : tests_) {
+            std::string text(source_.substr(t.first->start, t.first->end - t.first->start));
+            if (!jsonEqual(JsonParser::parse(text), t.first->test))
+                throw std::runtime_error("Test failed: " + t.second);
+        }
+
+        std::stable_sort(splices_.begin(), splices_.end(),
+                         [](const Splice& a, const Splice& b) { return a.begin < b.begin; });
+        size_t pos = 0;
+        for (const Splice& s : splices_) {
+            if (s.begin < pos) throw std::logic_error("Overlapping patch edits");
+            out.write(source_.data() + pos, static_cast<std::streamsize>(s.begin - pos));
+            out << s.before;
+            if (s.text >= 0) out << texts_[static_cast<size_t>(s.text)];
+            out << s.after;
+            pos = s.end;
+        }
+        out.write(source_.data() + pos, static_cast<std::streamsize>(source_.size() - pos));
+    }
+
+private:
+    // `in` is at the value `node` applies to; `path` is its pointer.
+    void value(JsonReader& in, PatchNode& node, std::string& path) {
+        const size_t start = in.offset();
+        const char c = in.peek();
+        if (node.merge && c == '{') {
+            container(in, node, path);
+        } else if (node.add || node.replace || node.merge) {
+            in.skipValue();
+            splices_.push_back({start, in.offset(), std::string(), node.text, std::string()});
+        } else if (!node.children.empty()) {
+            if (c != '{' && c != '[') {
+                appendJsonPointer(path, node.children.begin()->first);
+                throw std::runtime_error("No such path: " + path);
+            }
+            container(in, node, path);
+        } else {
+            in.skipValue();
+        }
+
+        // With duplicate keys the last occurrence counts, as in the parser.
+        node.start = start;
+        node.end = in.offset();
+        if (node.capture >= 0)
+            texts_[static_cast<size_t>(node.capture)].assign(source_.substr(start, node.end - start));
+        if (node.test && !node.seen) tests_.emplace_back(&node, path);
+        node.seen = true;
+    }
+
+    void container(JsonReader& in, PatchNode& node, std::string& path) {
+        const char open = in.peek();
+        const bool object = open == '{';
+        const char close = object ? '}' : ']';
+        in.expect(open);
+        const size_t inner = in.offset();
+        const size_t none = std::string_view::npos;
+
+        // Array elements are matched against the index tokens in order.
+        std::vector<std::pair<size_t, PatchNode*>> indexed;
+        if (!object) {
+            for (auto& kv : node.children) {
+                long long i = jsonPointerIndex(kv.first);
+                if (i >= 0) indexed.emplace_back(static_cast<size_t>(i), &kv.second);
+            }
+            std::sort(indexed.begin(), indexed.end(),
+                      [](const auto& a, const auto& b) { return a.first < b.first; });
+        }
+
+        // A run of removed items is cut out together with one separator: up
+        // to the next kept item, or from the end of the previous one.
+        size_t count = 0, kept = 0, next = 0;
+        size_t lastEnd = inner, lastKeptEnd = none, runStart = none;
+        // Inserted items are separated like the first two existing ones.
+        size_t firstStart = none, firstEnd = none, secondStart = none;
+        auto separator = [&]() -> std::string {
+            if (secondStart != none) return std::string(source_.substr(firstEnd, secondStart - firstEnd));
+            if (firstStart != none && firstStart > inner)
+                return "," + std::string(source_.substr(inner, firstStart - inner));
+            return ", ";
+        };
+        const size_t pathSize = path.size();
+        PatchNode* previous = nullptr;   // the member before this one, if patched
+        if (!in.consume(close)) {
+            do {
+                in.peek();
+                const size_t itemStart = in.offset();
+                if (count == 0) firstStart = itemStart;
+                if (count == 1) secondStart = itemStart;
+                if (previous) previous->nextStart = itemStart;
+                PatchNode* child = nullptr;
+                if (object) {
+                    std::string_view key = in.readKey(scratch_);
+                    auto it = node.children.find(key);
+                    if (it != node.children.end()) {
+                        child = &it->second;
+                        // A repeated key: the parser keeps the last occurrence, so
+                        // the earlier one goes (removals already cut them all).
+                        if (child->seen && !child->remove) {
+                            dropMember(*child);
+                            --kept;
+                        }
+                        child->keyStart = itemStart;
+                        appendJsonPointer(path, it->first);
+                    }
+                    in.expect(':');
+                    in.peek();
+                } else {
+                    if (next < indexed.size() && indexed[next].first == count) child = indexed[next++].second;
+                    if (child && child->add) {
+                        child->seen = true;
+                        splices_.push_back({itemStart, itemStart, std::string(), child->text, separator()});
+                        child = nullptr;
+                    }
+                    if (child) appendJsonPointer(path, std::to_string(count));
+                }
+
+                const bool removed = child && child->remove;
+                if (removed && runStart == none) runStart = itemStart;
+                if (!removed && runStart != none) {
+                    splices_.push_back({runStart, itemStart, std::string(), -1, std::string()});
+                    runStart = none;
+                }
+                if (child) value(in, *child, path);
+                else       in.skipValue();
+                previous = object ? child : nullptr;
+                path.resize(pathSize);
+                lastEnd = in.offset();
+                if (count == 0) firstEnd = lastEnd;
+                if (!removed) {
+                    lastKeptEnd = lastEnd;
+                    ++kept;
+                }
+                ++count;
+            } while (in.consume(','));
+            in.expect(close);
+        }
+        if (runStart != none)
+            splices_.push_back({lastKeptEnd != none ? lastKeptEnd : runStart, lastEnd,
+                                std::string(), -1, std::string()});
+
+        // Whatever was not found is appended, or missing.
+        for (auto& kv : node.children) {
+            PatchNode& child = kv.second;
+            if (child.seen) continue;
+            if (child.remove && !child.required) continue;   // merge-patch null
+            const bool append = child.add && (object || kv.first == "-"
+                                              || jsonPointerIndex(kv.first) == static_cast<long long>(count));
+            if (!append) {
+                appendJsonPointer(path, kv.first);
+                throw std::runtime_error("No such path: " + path);
+            }
+            std::ostringstream before;
+            if (kept++) before << separator();
+            if (object) {
+                printJsonString(before, kv.first);
+                before << ": ";
+            }
+            child.seen = true;
+            splices_.push_back({lastEnd, lastEnd, before.str(), child.text, std::string()});
+        }
+    }
+
+    // Cuts out an earlier occurrence of a repeated member, up to the member
+    // after it, and forgets what walking its value found and spliced.
+    void dropMember(PatchNode& node) {
+        const size_t from = node.keyStart, to = node.nextStart;
+        splices_.erase(std::remove_if(splices_.begin(), splices_.end(),
+                                      [&](const Splice& s) { return s.begin >= from && s.end <= to; }),
+                       splices_.end());
+        forget(node);
+        splices_.push_back({from, to, std::string(), -1, std::string()});
+    }
+
+    void forget(PatchNode& node) {
+        for (auto& kv : node.children) {
+            PatchNode& child = kv.second;
+            child.seen = false;
+            tests_.erase(std::remove_if(tests_.begin(), tests_.end(),
+                                        [&](const auto& t) { return t.first == &child; }),
+                         tests_.end());
+            forget(child);
+        }
+    }
+
+    std::string_view        source_;
+    PatchNode               root_;
+    std::vector<std::string> texts_;
+    std::vector<Splice>     splices_;
+    std::vector<std::pair<const PatchNode*, std::string>> tests_;   // with their pointers
+    std::string             scratch_;
+};
+
+// The value a merge patch leaves where there was nothing to merge into:
+// the patch with its null members dropped.
+std::string mergedText(const std::shared_ptr<JsonValue>& patch) {
+    std::shared_ptr<JsonValue> value;
+    applyJsonMergePatch(value, patch);
+    return compactText(value);
+}
+
+void buildMerge(PatchStreamer& s, PatchNode& node, const std::shared_ptr<JsonValue>& patch) {
+    for (const auto& kv : patch->getObject()) {
+        PatchNode& child = node.children[std::string(kv.first)];
+        if (typeOf(kv.second) == Type::Null) {
+            child.remove = true;
+            continue;
+        }
+        child.add = true;
+        child.text = s.addText(mergedText(kv.second));
+        if (typeOf(kv.second) == Type::Object) {
+            child.merge = true;
+            buildMerge(s, child, kv.second);
+        }
+    }
+}
+
+} // namespace
+
+/* --------------------------------------------------------------- */
+JsonPatch parseJsonPatch(const std::shared_ptr<JsonValue>& patch) {
+    if (typeOf(patch) != Type::Array) throw std::runtime_error("A JSON Patch must be an array of operations");
+    static const std::pair<const char*, JsonPatchOperation::Op> kOps[] = {
+        {"add", JsonPatchOperation::Op::Add},   {"remove", JsonPatchOperation::Op::Remove},
+        {"replace", JsonPatchOperation::Op::Replace}, {"move", JsonPatchOperation::Op::Move},
+        {"copy", JsonPatchOperation::Op::Copy}, {"test", JsonPatchOperation::Op::Test},
+    };
+
+    JsonPatch ops;
+    const JsonArray& a = patch->getArray();
+    for (size_t i = 0; i < a.size(); ++i) {
+        const std::string where = "Patch operation " + std::to_string(i) + ": ";
+        if (typeOf(a[i]) != Type::Object) throw std::runtime_error(where + "not an object");
+        const JsonObject& o = a[i]->getObject();
+        auto member = [&](const char* name) -> std::shared_ptr<JsonValue> {
+            auto it = o.find(JsonString(name));
+            return it == o.end() ? nullptr : it->second;
+        };
+        auto pointer = [&](const char* name) {
+            std::shared_ptr<JsonValue> v = member(name);
+            if (!v || v->getType() != Type::String)
+                throw std::runtime_error(where + "\"" + name + "\" must be a JSON Pointer string");
+            std::string s(v->getString());
+            try { parseJsonPointer(s); } catch (const std::exception& e) { throw std::runtime_error(where + e.what()); }
+            return s;
+        };
+
+        std::shared_ptr<JsonValue> name = member("op");
+        if (!name || name->getType() != Type::String) throw std::runtime_error(where + "missing \"op\"");
+        auto known = std::find_if(std::begin(kOps), std::end(kOps),
+                                  [&](const auto& k) { return name->getString() == k.first; });
+        if (known == std::end(kOps))
+            throw std::runtime_error(where + "unknown op \"" + std::string(name->getString()) + "\"");
+
+        JsonPatchOperation op{known->second, pointer("path"), std::string(), nullptr};
+        if (op.op == JsonPatchOperation::Op::Move || op.op == JsonPatchOperation::Op::Copy)
+            op.from = pointer("from");
+        if (op.op == JsonPatchOperation::Op::Add || op.op == JsonPatchOperation::Op::Replace
+            || op.op == JsonPatchOperation::Op::Test) {
+            op.value = member("value");
+            if (!op.value) throw std::runtime_error(where + "missing \"value\"");
+        }
+        ops.push_back(std::move(op));
+    }
+    return ops;
+}
+
+void applyJsonPatch(std::shared_ptr<JsonValue>& root, const JsonPatch& patch, std::pmr::memory_resource* mr) {
+    using Op = JsonPatchOperation::Op;
+    for (const auto& op : patch) {
+        const std::vector<std::string> path = parseJsonPointer(op.path);
+        switch (op.op) {
+        case Op::Add:
+            addValue(root, path, cloneJson(op.value, mr));
+            break;
+        case Op::Remove:
+            removeValue(root, path);
+            break;
+        case Op::Replace:
+            existing(root, path) = cloneJson(op.value, mr);
+            break;
+        case Op::Move: {
+            const std::vector<std::string> from = parseJsonPointer(op.from);
+            if (op.from == op.path) {
+                existing(root, from);
+                break;
+            }
+            if (isPrefix(from, path)) throw std::runtime_error("Cannot move " + op.from + " into itself");
+            addValue(root, path, removeValue(root, from));
+            break;
+        }
+        case Op::Copy:
+            addValue(root, path, cloneJson(existing(root, parseJsonPointer(op.from)), mr));
+            break;
+        case Op::Test:
+            if (!jsonEqual(existing(root, path), op.value)) throw std::runtime_error("Test failed: " + op.path);
+            break;
+        }
+    }
+}
+
+void applyJsonMergePatch(std::shared_ptr<JsonValue>& root, const std::shared_ptr<JsonValue>& patch,
+                         std::pmr::memory_resource* mr) {
+    if (typeOf(patch) != Type::Object) {
+        root = cloneJson(patch, mr);
+        return;
+    }
+    if (typeOf(root) != Type::Object) root = makeJsonValue(mr, JsonObject(mr));
+    JsonObject& o = root->getObject();
+    for (const auto& kv : patch->getObject()) {
+        if (typeOf(kv.second) == Type::Null) {
+            o.erase(kv.first);
+            continue;
+        }
+        auto it = o.find(kv.first);
+        if (it == o.end()) it = o.emplace(kv.first, nullptr).first;
+        applyJsonMergePatch(it->second, kv.second, mr);
+    }
+}
+
+std::shared_ptr<JsonValue> cloneJson(const std::shared_ptr<JsonValue>& value, std::pmr::memory_resource* mr) {
+    std::shared_ptr<JsonValue> copy;
+    switch (typeOf(value)) {
+    case Type::Null:   return makeJsonValue(mr);
+    case Type::Bool:   return makeJsonValue(mr, value->getBool());
+    case Type::Number: copy = makeJsonValue(mr, value->getNumber()); break;
+    case Type::String: copy = makeJsonValue(mr, JsonString(value->getString(), mr)); break;
+    case Type::Array: {
+        JsonArray a(mr);
+        a.reserve(value->getArray().size());
+        for (const auto& e : value->getArray()) a.push_back(cloneJson(e, mr));
+        return makeJsonValue(mr, std::move(a));
+    }
+    case Type::Object: {
+        JsonObject o(mr);
+        o.reserve(value->getObject().size());
+        for (const auto& kv : value->getObject()) o.emplace(kv.first, cloneJson(kv.second, mr));
+        return makeJsonValue(mr, std::move(o));
+    }
+    }
+    copy->setLexeme(value->getLexeme());   // still points into the original source
+    return copy;
+}
+
+bool jsonEqual(const std::shared_ptr<JsonValue>& a, const std::shared_ptr<JsonValue>& b) {
+    const Type t = typeOf(a);
+    if (t != typeOf(b)) return false;
+    switch (t) {
+    case Type::Null:   return true;
+    case Type::Bool:   return a->getBool() == b->getBool();
+    case Type::Number: return a->getNumber() == b->getNumber();
+    case Type::String: return a->getString() == b->getString();
+    case Type::Array: {
+        const JsonArray& x = a->getArray();
+        const JsonArray& y = b->getArray();
+        if (x.size() != y.size()) return false;
+        for (size_t i = 0; i < x.size(); ++i)
+            if (!jsonEqual(x[i], y[i])) return false;
+        return true;
+    }
+    case Type::Object: {
+        const JsonObject& x = a->getObject();
+        const JsonObject& y = b->getObject();
+        if (x.size() != y.size()) return false;
+        for (const auto& kv : x) {
+            auto it = y.find(kv.first);
+            if (it == y.end() || !jsonEqual(kv.second, it->second)) return false;
+        }
+        return true;
+    }
+    }
+    return false;
+}
+
+bool canStreamJsonPatch(const JsonPatch& patch) {
+    using Op = JsonPatchOperation::Op;
+    // Every path an operation touches, and whether it inserts or removes there.
+    std::vector<std::pair<std::vector<std::string>, bool>> touched;
+    for (const auto& op : patch) {
+        touched.emplace_back(parseJsonPointer(op.path), op.op != Op::Replace && op.op != Op::Test);
+        if (op.op == Op::Move || op.op == Op::Copy) touched.emplace_back(parseJsonPointer(op.from), op.op == Op::Move);
+    }
+    std::vector<std::vector<std::string>> paths;
+    for (const auto& t : touched) {
+        if (t.first.empty()) return false;   // the whole document
+        paths.push_back(t.first);
+    }
+
+    // Sorted, a path is followed directly by the paths it contains.
+    std::sort(paths.begin(), paths.end());
+    for (size_t i = 0; i + 1 < paths.size(); ++i)
+        if (isPrefix(paths[i], paths[i + 1])) return false;
+
+    // An array insertion or removal shifts its siblings: nothing else may
+    // be addressed inside that array.
+    for (const auto& t : touched) {
+        const std::string& last = t.first.back();
+        if (!t.second || (last != "-" && jsonPointerIndex(last) < 0)) continue;
+        const std::vector<std::string> parent(t.first.begin(), t.first.end() - 1);
+        auto it = std::lower_bound(paths.begin(), paths.end(), parent);
+        if (it != paths.end() && isPrefix(parent, *it) && it + 1 != paths.end() && isPrefix(parent, *(it + 1)))
+            return false;
+    }
+    return true;
+}
+
+void streamJsonPatch(std::string_view source, const JsonPatch& patch, std::ostream& out) {
+    using Op = JsonPatchOperation::Op;
+    if (!canStreamJsonPatch(patch)) throw std::runtime_error("This patch cannot be applied as a stream");
+    PatchStreamer s(source);
+    for (const auto& op : patch) {
+        PatchNode& n = s.node(parseJsonPointer(op.path));
+        switch (op.op) {
+        case Op::Add:
+            n.add = true;
+            n.text = s.addText(compactText(op.value));
+            break;
+        case Op::Remove:
+            n.remove = n.required = true;
+            break;
+        case Op::Replace:
+            n.replace = n.required = true;
+            n.text = s.addText(compactText(op.value));
+            break;
+        case Op::Test:
+            n.required = true;
+            n.test = op.value;
+            break;
+        case Op::Move:
+        case Op::Copy: {
+            PatchNode& from = s.node(parseJsonPointer(op.from));
+            from.required = true;
+            from.remove = op.op == Op::Move;
+            from.capture = s.addText(std::string());
+            n.add = true;
+            n.text = from.capture;
+            break;
+        }
+        }
+    }
+    s.run(out);
+}
+
+void streamJsonMergePatch(std::string_view source, const std::shared_ptr<JsonValue>& patch, std::ostream& out) {
+    if (typeOf(patch) != Type::Object) {   // replaces the document
+        out << compactText(patch);
+        return;
+    }
+    PatchStreamer s(source);
+    PatchNode& root = s.root();
+    root.merge = true;
+    root.text = s.addText(mergedText(patch));
+    buildMerge(s, root, patch);
+    s.run(out);
+}
@@ -0,0 +1,67 @@
+#ifndef JSONPATCH_H
+#define JSONPATCH_H
+
+#include <memory>
+#include <memory_resource>
+#include <ostream>
+#include <string>
+#include <string_view>
+#include <vector>
+#include "jsonparser.h"
+
+// JSON Patch (RFC 6902) and JSON Merge Patch (RFC 7396), applied either in
+// place to a parsed document or as a streaming rewrite of its source text.
+
+struct JsonPatchOperation {
+    enum class Op { Add, Remove, Replace, Move, Copy, Test };
+    Op op;
+    std::string path;                   // JSON Pointer
+    std::string from;                   // move, copy
+    std::shared_ptr<JsonValue> value;   // add, replace, test
+};
+
+using JsonPatch = std::vector<JsonPatchOperation>;
+
+// The operations of an RFC 6902 patch document (an array of operation
+// objects); throws std::runtime_error naming the first malformed one.
+JsonPatch parseJsonPatch(const std::shared_ptr<JsonValue>& patch);
+
+// Applies the operations in order, editing the document in place; `root`
+// itself is replaced by operations on "". Values taken from the patch are
+// copied, so a patch can be applied to many documents, and new nodes are
+// allocated from `mr`. Throws std::runtime_error ("No such path: ...",
+// "Test failed: ...") at the first operation that fails; the ones before it
+// stay applied.
+void applyJsonPatch(std::shared_ptr<JsonValue>& root, const JsonPatch& patch,
+                    std::pmr::memory_resource* mr = std::pmr::get_default_resource());
+
+// Merges `patch` into the document in place: null members remove, objects
+// merge recursively, anything else replaces.
+void applyJsonMergePatch(std::shared_ptr<JsonValue>& root, const std::shared_ptr<JsonValue>& patch,
+                         std::pmr::memory_resource* mr = std::pmr::get_default_resource());
+
+// Deep copy of `value` allocated from `mr`.
+std::shared_ptr<JsonValue> cloneJson(const std::shared_ptr<JsonValue>& value,
+                                     std::pmr::memory_resource* mr = std::pmr::get_default_resource());
+
+// Structural equality as RFC 6902 "test" defines it: numbers by value,
+// objects regardless of member order.
+bool jsonEqual(const std::shared_ptr<JsonValue>& a, const std::shared_ptr<JsonValue>& b);
+
+// True when the operations touch independent paths, so that applying them
+// to the original document at once gives the same result as applying them
+// in order: no path (or "from") lies inside another, and no operation that
+// inserts or removes an array element shares that array with another one.
+bool canStreamJsonPatch(const JsonPatch& patch);
+
+// Writes `source` (strict JSON) to `out` with the patch applied, copying the
+// bytes outside the edited values verbatim; only the containers on the
+// patched paths are inspected, everything else is skipped over. Inserted and
+// replaced values are written compactly; moved and copied ones as their
+// source text. Nothing is written if an operation fails. The JSON Patch
+// form requires canStreamJsonPatch(patch).
+void streamJsonPatch(std::string_view source, const JsonPatch& patch, std::ostream& out);
+void streamJsonMergePatch(std::string_view source, const std::shared_ptr<JsonValue>& patch,
+                          std::ostream& out);
+
+#endif // JSONPATCH_H
@@ -0,0 +1,75 @@
+#include "jsonpointer.h"
+#include <stdexcept>
+
+void appendJsonPointer(std::string& pointer, std::string_view token) {
+    pointer += '/';
+    for (char c : token) {
+        if (c == '~')      pointer += "~0";
+        else if (c == '/') pointer += "~1";
+        else               pointer += c;
+    }
+}
+
+std::vector<std::string> parseJsonPointer(std::string_view pointer) {
+    std::vector<std::string> tokens;
+    if (pointer.empty()) return tokens;
+    if (pointer[0] != '/')
+        throw std::runtime_error("Invalid JSON Pointer \"" + std::string(pointer) + "\": must start with '/'");
+    for (size_t i = 0; i < pointer.size();) {
+        ++i;   // the '/'
+        std::string token;
+        for (; i < pointer.size() && pointer[i] != '/'; ++i) {
+            char c = pointer[i];
+            if (c == '~') {
+                char e = i + 1 < pointer.size() ? pointer[i + 1] : '\0';
+                if (e != '0' && e != '1')
+                    throw std::runtime_error("Invalid JSON Pointer \"" + std::string(pointer) + "\": bad '~' escape");
+                c = e == '0' ? '~' : '/';
+                ++i;
+            }
+            token += c;
+        }
+        tokens.push_back(std::move(token));
+    }
+    return tokens;
+}
+
+long long jsonPointerIndex(std::string_view token) {
+    if (token.empty() || token.size() > 18 || (token.size() > 1 && token[0] == '0')) return -1;
+    long long v = 0;
+    for (char c : token) {
+        if (c < '0' || c > '9') return -1;
+        v = v * 10 + (c - '0');
+    }
+    return v;
+}
+
+std::shared_ptr<JsonValue> resolveJsonPointer(const std::shared_ptr<JsonValue>& root,
+                                              std::string_view pointer) {
+    std::string resolved;
+    return resolveJsonPointer(root, parseJsonPointer(pointer), 0, resolved);
+}
+
+std::shared_ptr<JsonValue> resolveJsonPointer(std::shared_ptr<JsonValue> node,
+                                              const std::vector<std::string>& tokens,
+                                              size_t first, std::string& resolved) {
+    for (size_t t = first; t < tokens.size(); ++t) {
+        const std::string& token = tokens[t];
+        appendJsonPointer(resolved, token);
+        auto type = node ? node->getType() : JsonValue::Type::Null;
+        if (type == JsonValue::Type::Object) {
+            const auto& o = node->getObject();
+            auto it = o.find(JsonString(token));
+            if (it == o.end()) throw std::runtime_error("No such path: " + resolved);
+            node = it->second;
+        } else if (type == JsonValue::Type::Array) {
+            const auto& a = node->getArray();
+            long long i = jsonPointerIndex(token);
+            if (i < 0 || static_cast<size_t>(i) >= a.size()) throw std::runtime_error("No such path: " + resolved);
+            node = a[static_cast<size_t>(i)];
+        } else {
+            throw std::runtime_error("No such path: " + resolved);
+        }
+    }
+    return node;
+}
@@ -0,0 +1,35 @@
+#ifndef JSONPOINTER_H
+#define JSONPOINTER_H
+
+#include <memory>
+#include <string>
+#include <string_view>
+#include <vector>
+#include "jsonparser.h"
+
+// JSON Pointer (RFC 6901) helpers. "" is the whole document, "/a/0" is
+// member "a", element 0; '~' and '/' inside a token are written ~0 and ~1.
+
+// Appends "/" + token to a pointer, escaping '~' and '/'.
+void appendJsonPointer(std::string& pointer, std::string_view token);
+
+// The unescaped reference tokens of `pointer`; throws std::runtime_error if
+// it is neither empty nor starts with '/', or has a bad escape.
+std::vector<std::string> parseJsonPointer(std::string_view pointer);
+
+// Index named by an array reference token, or -1 if the token is not a
+// canonical non-negative integer ("0", "17"; not "01" or "-").
+long long jsonPointerIndex(std::string_view token);
+
+// The value at `pointer`; throws std::runtime_error naming the first token
+// that does not resolve.
+std::shared_ptr<JsonValue> resolveJsonPointer(const std::shared_ptr<JsonValue>& root,
+                                              std::string_view pointer);
+
+// Resolves tokens[first..] starting at `node`, whose own pointer is
+// `resolved`; `resolved` is extended token by token for error messages.
+std::shared_ptr<JsonValue> resolveJsonPointer(std::shared_ptr<JsonValue> node,
+                                              const std::vector<std::string>& tokens,
+                                              size_t first, std::string& resolved);
+
+#endif // JSONPOINTER_H
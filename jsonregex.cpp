@@ -0,0 +1,517 @@
+#include "jsonregex.h"
+#include <algorithm>
+#include <stdexcept>
+
+namespace {
+
+using Ranges = std::vector<std::pair<uint32_t, uint32_t>>;
+
+constexpr uint32_t kMaxCodePoint = 0x10FFFF;
+constexpr uint32_t kUnbounded    = UINT32_MAX;     // {n,} and * / +
+constexpr uint32_t kMaxCount     = 100000;         // largest n in {n,m}
+constexpr size_t   kMaxProgram   = 100000;         // instructions after expanding {n,m}
+constexpr unsigned kMaxNesting   = 256;            // groups within groups
+
+// One code point; a malformed or truncated sequence yields its first byte.
+uint32_t decodeUtf8(const char*& p, const char* end) {
+    const unsigned char c = static_cast<unsigned char>(*p);
+    const int n = c < 0x80 ? 0 : (c >> 5) == 0x6 ? 1 : (c >> 4) == 0xE ? 2 : (c >> 3) == 0x1E ? 3 : -1;
+    if (n <= 0 || end - p <= n) { ++p; return c; }
+    uint32_t cp = c & (0x3Fu >> n);
+    for (int i = 1; i <= n; ++i) {
+        const unsigned char b = static_cast<unsigned char>(p[i]);
+        if ((b & 0xC0) != 0x80) { ++p; return c; }
+        cp = (cp << 6) | (b & 0x3F);
+    }
+    p += n + 1;
+    return cp;
+}
+
+bool isWord(uint32_t cp) {
+    return (cp >= 'a' && cp <= 'z') || (cp >= 'A' && cp <= 'Z') || (cp >= '0' && cp <= '9') || cp == '_';
+}
+
+int hexValue(char c) {
+    if (c >= '0' && c <= '9') return c - '0';
+    if (c >= 'a' && c <= 'f') return c - 'a' + 10;
+    if (c >= 'A' && c <= 'F') return c - 'A' + 10;
+    return -1;
+}
+
+Ranges normalize(Ranges r) {
+    std::sort(r.begin(), r.end());
+    Ranges out;
+    for (const auto& x : r) {
+        if (!out.empty() && x.first <= out.back().second + 1)
+            out.back().second = std::max(out.back().second, x.second);
+        else
+            out.push_back(x);
+    }
+    return out;
+}
+
+Ranges complement(const Ranges& sorted) {
+    Ranges out;
+    uint32_t next = 0;
+    for (const auto& x : sorted) {
+        if (x.first > next) out.push_back({next, x.first - 1});
+        next = x.second + 1;
+    }
+    if (next <= kMaxCodePoint) out.push_back({next, kMaxCodePoint});
+    return out;
+}
+
+const Ranges kDigit = {{'0', '9'}};
+const Ranges kWord  = {{'0', '9'}, {'A', 'Z'}, {'_', '_'}, {'a', 'z'}};
+const Ranges kSpace = {{0x09, 0x0D}, {0x20, 0x20}, {0xA0, 0xA0}, {0x1680, 0x1680}, {0x2000, 0x200A},
+                       {0x2028, 0x2029}, {0x202F, 0x202F}, {0x205F, 0x205F}, {0x3000, 0x3000},
+                       {0xFEFF, 0xFEFF}};
+const Ranges kLineTerminators = {{0x0A, 0x0A}, {0x0D, 0x0D}, {0x2028, 0x2029}};
+
+bool inRanges(const Ranges& r, uint32_t cp) {
+    auto it = std::upper_bound(r.begin(), r.end(), cp,
+                               [](uint32_t c, const std::pair<uint32_t, uint32_t>& x) { return c < x.first; });
+    return it != r.begin() && cp <= std::prev(it)->second;
+}
+
+// Sparse set of instruction indices: O(1) insert, membership and clear.
+struct ThreadList {
+    uint32_t* dense;
+    uint32_t* sparse;
+    size_t    size = 0;
+
+    bool contains(uint32_t pc) const { return sparse[pc] < size && dense[sparse[pc]] == pc; }
+    void add(uint32_t pc) { sparse[pc] = static_cast<uint32_t>(size); dense[size++] = pc; }
+};
+
+// What the zero-width assertions see at one position of the input.
+struct Position {
+    bool atStart, atEnd, wordBefore, wordAfter;
+};
+
+} // namespace
+
+/* --------------------------------------------------------------- */
+// Recursive descent over the pattern into a syntax tree, then code for the
+// VM. Recursion follows group nesting only, which is capped.
+struct JsonRegex::Compiler {
+    struct Unsupported {};   // needs backtracking: use std::regex
+
+    struct Node {
+        enum Kind { Concat, Alt, Repeat, Set, Begin, End, WordBoundary, NotWordBoundary } kind;
+        std::vector<Node> kids;
+        uint32_t set = 0;
+        uint32_t min = 0, max = 0;
+    };
+
+    const std::string& src;
+    JsonRegex&         re;
+    size_t             i = 0;
+    unsigned           depth = 0;
+
+    [[noreturn]] void fail(const std::string& msg) const {
+        throw std::runtime_error(msg + " at offset " + std::to_string(i));
+    }
+    bool more() const { return i < src.size(); }
+    bool at(char c) const { return i < src.size() && src[i] == c; }
+    uint32_t next() {
+        const char* p = src.data() + i;
+        uint32_t cp = decodeUtf8(p, src.data() + src.size());
+        i = static_cast<size_t>(p - src.data());
+        return cp;
+    }
+
+    Node setNode(Ranges r) {
+        re.sets_.push_back(normalize(std::move(r)));
+        Node n{Node::Set, {}};
+        n.set = static_cast<uint32_t>(re.sets_.size() - 1);
+        return n;
+    }
+
+    void compile() {
+        Node root = alternation();
+        if (more()) fail("Unmatched )");
+        emit(root);
+        push({Op::Match});
+        re.anchored_ = re.prog_.front().op == Op::Begin;
+    }
+
+    /* ---- Parsing ---- */
+    Node alternation() {
+        Node first = sequence();
+        if (!at('|')) return first;
+        Node alt{Node::Alt, {}};
+        alt.kids.push_back(std::move(first));
+        while (at('|')) {
+            ++i;
+            alt.kids.push_back(sequence());
+        }
+        return alt;
+    }
+
+    Node sequence() {
+        Node seq{Node::Concat, {}};
+        while (more() && !at('|') && !at(')')) {
+            Node a = atom();
+            quantify(a);
+            seq.kids.push_back(std::move(a));
+        }
+        return seq;
+    }
+
+    Node atom() {
+        switch (src[i]) {
+            case '^':  ++i; return Node{Node::Begin, {}};
+            case '$':  ++i; return Node{Node::End, {}};
+            case '.':  ++i; return setNode(complement(kLineTerminators));
+            case '(':  return group();
+            case '[':  return setNode(charClass());
+            case '\\': return escape();
+            case '*': case '+': case '?':
+                fail("Nothing to repeat");
+            case '{': {
+                uint32_t min, max;
+                size_t save = i;
+                if (braces(min, max)) { i = save; fail("Nothing to repeat"); }
+                break;   // not a quantifier: a literal brace
+            }
+            default: break;
+        }
+        uint32_t cp = next();
+        return setNode({{cp, cp}});
+    }
+
+    // {n}, {n,} or {n,m} at i; leaves i after it. False (i unchanged) if
+    // the text there is not a quantifier.
+    bool braces(uint32_t& min, uint32_t& max) {
+        size_t j = i + 1;
+        auto number = [&](uint32_t& v) {
+            size_t first = j;
+            v = 0;
+            for (; j < src.size() && src[j] >= '0' && src[j] <= '9'; ++j) {
+                v = v * 10 + static_cast<uint32_t>(src[j] - '0');
+                if (v > kMaxCount) { i = first; fail("Quantifier too large"); }
+            }
+            return j != first;
+        };
+        if (!number(min)) return false;
+        max = min;
+        if (j < src.size() && src[j] == ',') {
+            ++j;
+            if (!number(max)) max = kUnbounded;
+        }
+        if (j >= src.size() || src[j] != '}') return false;
+        i = j + 1;
+        return true;
+    }
+
+    void quantify(Node& a) {
+        if (!more()) return;
+        uint32_t min, max;
+        switch (src[i]) {
+            case '*': ++i; min = 0; max = kUnbounded; break;
+            case '+': ++i; min = 1; max = kUnbounded; break;
+            case '?': ++i; min = 0; max = 1; break;
+            case '{':
+                if (!braces(min, max)) return;
+                if (min > max) fail("Numbers out of order in {} quantifier");
+                break;
+            default: return;
+        }
+        if (at('?')) ++i;   // lazy: matches the same strings
+        Node r{Node::Repeat, {}};
+        r.min = min;
+        r.max = max;
+        r.kids.push_back(std::move(a));
+        a = std::move(r);
+    }
+
+    Node group() {
+        ++i;
+        if (++depth > kMaxNesting) fail("Pattern nested too deeply");
+        if (at('?')) {
+            if (i + 1 < src.size() && src[i+1] == ':') {
+                i += 2;
+            } else if (i + 2 < src.size() && src[i+1] == '<' && src[i+2] != '=' && src[i+2] != '!') {
+                size_t close = src.find('>', i);
+                if (close == std::string::npos) fail("Invalid capture group name");
+                i = close + 1;
+            } else if (i + 1 < src.size() && (src[i+1] == '=' || src[i+1] == '!' || src[i+1] == '<')) {
+                throw Unsupported{};   // lookahead, lookbehind
+            } else {
+                fail("Invalid group");
+            }
+        }
+        Node inner = alternation();
+        if (!at(')')) fail("Missing )");
+        ++i;
+        --depth;
+        return inner;
+    }
+
+    Node escape() {
+        ++i;
+        if (!more()) fail("\\ at end of pattern");
+        switch (src[i]) {
+            case 'b': ++i; return Node{Node::WordBoundary, {}};
+            case 'B': ++i; return Node{Node::NotWordBoundary, {}};
+            case 'k': throw Unsupported{};   // named backreference
+            default: {
+                bool single;
+                return setNode(classEscape(single));
+            }
+        }
+    }
+
+    // The escape after a backslash, as a set of code points; `single` when
+    // it stands for one character (which may bound a class range).
+    Ranges classEscape(bool& single) {
+        single = false;
+        const char c = src[i];
+        switch (c) {
+            case 'd': ++i; return kDigit;
+            case 'D': ++i; return complement(kDigit);
+            case 'w': ++i; return kWord;
+            case 'W': ++i; return complement(kWord);
+            case 's': ++i; return kSpace;
+            case 'S': ++i; return complement(normalize(kSpace));
+            default: break;
+        }
+        single = true;
+        uint32_t cp;
+        switch (c) {
+            case 't': ++i; cp = '\t'; break;
+            case 'n': ++i; cp = '\n'; break;
+            case 'v': ++i; cp = '\v'; break;
+            case 'f': ++i; cp = '\f'; break;
+            case 'r': ++i; cp = '\r'; break;
+            case 'b': ++i; cp = '\b'; break;   // only reached inside a class
+            case '0':
+                if (i + 1 < src.size() && src[i+1] >= '0' && src[i+1] <= '9') throw Unsupported{};
+                ++i; cp = 0;
+                break;
+            case 'x':
+                if (i + 2 < src.size() && hexValue(src[i+1]) >= 0 && hexValue(src[i+2]) >= 0) {
+                    cp = static_cast<uint32_t>(hexValue(src[i+1]) * 16 + hexValue(src[i+2]));
+                    i += 3;
+                } else {
+                    ++i; cp = 'x';
+                }
+                break;
+            case 'u':
+                cp = hex4(i + 1);
+                if (cp == kUnbounded) { ++i; cp = 'u'; break; }
+                i += 5;
+                if (cp >= 0xD800 && cp <= 0xDBFF && i + 1 < src.size() && src[i] == '\\' && src[i+1] == 'u') {
+                    uint32_t lo = hex4(i + 2);
+                    if (lo >= 0xDC00 && lo <= 0xDFFF) {
+                        cp = 0x10000 + ((cp - 0xD800) << 10) + (lo - 0xDC00);
+                        i += 6;
+                    }
+                }
+                break;
+            case 'c':
+                if (i + 1 < src.size() && ((src[i+1] | 0x20) >= 'a' && (src[i+1] | 0x20) <= 'z')) {
+                    cp = static_cast<uint32_t>(src[i+1]) % 32;
+                    i += 2;
+                } else {
+                    cp = '\\';   // Annex B: the backslash is literal, "c" follows
+                }
+                break;
+            default:
+                if (c >= '1' && c <= '9') throw Unsupported{};   // backreference (or octal in a class)
+                cp = next();                                   // identity escape
+                break;
+        }
+        return {{cp, cp}};
+    }
+
+    // Four hex digits at `j`, or kUnbounded.
+    uint32_t hex4(size_t j) const {
+        if (j + 4 > src.size()) return kUnbounded;
+        uint32_t v = 0;
+        for (size_t k = j; k < j + 4; ++k) {
+            int h = hexValue(src[k]);
+            if (h < 0) return kUnbounded;
+            v = v * 16 + static_cast<uint32_t>(h);
+        }
+        return v;
+    }
+
+    Ranges classAtom(bool& single) {
+        if (at('\\')) {
+            ++i;
+            if (!more()) fail("\\ at end of pattern");
+            return classEscape(single);
+        }
+        single = true;
+        uint32_t cp = next();
+        return {{cp, cp}};
+    }
+
+    Ranges charClass() {
+        ++i;
+        bool negated = at('^');
+        if (negated) ++i;
+        Ranges r;
+        for (;;) {
+            if (!more()) fail("Missing ]");
+            if (at(']')) { ++i; break; }
+            bool single;
+            Ranges lo = classAtom(single);
+            if (single && at('-') && i + 1 < src.size() && src[i+1] != ']') {
+                size_t dash = i++;
+                bool hiSingle;
+                Ranges hi = classAtom(hiSingle);
+                if (hiSingle) {
+                    if (hi[0].first < lo[0].first) { i = dash; fail("Range out of order in character class"); }
+                    r.push_back({lo[0].first, hi[0].first});
+                    continue;
+                }
+                r.push_back({'-', '-'});   // Annex B: [a-\d] is a, -, and digits
+                r.insert(r.end(), hi.begin(), hi.end());
+            }
+            r.insert(r.end(), lo.begin(), lo.end());
+        }
+        r = normalize(std::move(r));
+        return negated ? complement(r) : r;
+    }
+
+    /* ---- Code generation ---- */
+    uint32_t push(Inst inst) {
+        if (re.prog_.size() >= kMaxProgram) fail("Pattern too large");
+        re.prog_.push_back(inst);
+        return static_cast<uint32_t>(re.prog_.size() - 1);
+    }
+    uint32_t here() const { return static_cast<uint32_t>(re.prog_.size()); }
+
+    void emit(const Node& n) {
+        switch (n.kind) {
+        case Node::Concat:
+            for (const auto& k : n.kids) emit(k);
+            break;
+        case Node::Set:             push({Op::Set, n.set}); break;
+        case Node::Begin:           push({Op::Begin}); break;
+        case Node::End:             push({Op::End}); break;
+        case Node::WordBoundary:    push({Op::WordBoundary}); break;
+        case Node::NotWordBoundary: push({Op::NotWordBoundary}); break;
+        case Node::Alt: {
+            std::vector<uint32_t> exits;
+            for (size_t k = 0; k + 1 < n.kids.size(); ++k) {
+                uint32_t split = push({Op::Split});
+                re.prog_[split].x = here();
+                emit(n.kids[k]);
+                exits.push_back(push({Op::Jmp}));
+                re.prog_[split].y = here();
+            }
+            emit(n.kids.back());
+            for (uint32_t e : exits) re.prog_[e].x = here();
+            break;
+        }
+        case Node::Repeat: {
+            for (uint32_t k = 0; k < n.min; ++k) emit(n.kids[0]);
+            if (n.max == kUnbounded) {
+                uint32_t split = push({Op::Split});
+                re.prog_[split].x = here();
+                emit(n.kids[0]);
+                push({Op::Jmp, split});
+                re.prog_[split].y = here();
+            } else {
+                std::vector<uint32_t> splits;
+                for (uint32_t k = n.min; k < n.max; ++k) {
+                    splits.push_back(push({Op::Split}));
+                    re.prog_[splits.back()].x = here();
+                    emit(n.kids[0]);
+                }
+                for (uint32_t s : splits) re.prog_[s].y = here();
+            }
+            break;
+        }
+        }
+    }
+};
+
+/* --------------------------------------------------------------- */
+JsonRegex::JsonRegex(const std::string& pattern) {
+    try {
+        Compiler{pattern, *this}.compile();
+    } catch (const Compiler::Unsupported&) {
+        prog_.clear();
+        sets_.clear();
+        try {
+            fallback_.emplace(pattern, std::regex::ECMAScript | std::regex::optimize);
+        } catch (const std::regex_error& e) {
+            throw std::runtime_error(e.what());
+        }
+    }
+}
+
+/* --------------------------------------------------------------- */
+// Pike VM: every instruction is a state, all live states advance together
+// one code point at a time, and a state is entered at most once per step.
+bool JsonRegex::search(std::string_view s) const {
+    if (fallback_) return std::regex_search(s.begin(), s.end(), *fallback_);
+
+    // dense + sparse for two lists, and a stack for the epsilon closure
+    const size_t n = prog_.size();
+    static thread_local std::vector<uint32_t> scratch;
+    if (scratch.size() < 6 * n + 1) scratch.resize(6 * n + 1);
+    ThreadList cur{scratch.data(), scratch.data() + n};
+    ThreadList nxt{scratch.data() + 2 * n, scratch.data() + 3 * n};
+    uint32_t* stack = scratch.data() + 4 * n;
+
+    // Adds pc and everything reachable from it without consuming input;
+    // true once Match is reached.
+    auto add = [&](ThreadList& list, uint32_t pc0, const Position& at) {
+        size_t top = 0;
+        stack[top++] = pc0;
+        while (top) {
+            uint32_t pc = stack[--top];
+            if (list.contains(pc)) continue;
+            list.add(pc);
+            const Inst& in = prog_[pc];
+            switch (in.op) {
+                case Op::Set:   break;
+                case Op::Match: return true;
+                case Op::Jmp:   stack[top++] = in.x; break;
+                case Op::Split: stack[top++] = in.y; stack[top++] = in.x; break;
+                case Op::Begin: if (at.atStart) stack[top++] = pc + 1; break;
+                case Op::End:   if (at.atEnd) stack[top++] = pc + 1; break;
+                case Op::WordBoundary:
+                    if (at.wordBefore != at.wordAfter) stack[top++] = pc + 1;
+                    break;
+                case Op::NotWordBoundary:
+                    if (at.wordBefore == at.wordAfter) stack[top++] = pc + 1;
+                    break;
+            }
+        }
+        return false;
+    };
+
+    const char* const begin = s.data();
+    const char* const end   = begin + s.size();
+    const char* p = begin;                       // current position
+    const char* q = p;                           // after the code point at p
+    uint32_t cp = p != end ? decodeUtf8(q, end) : 0;
+    bool wordBefore = false;
+    for (;;) {
+        const Position here{p == begin, p == end, wordBefore, p != end && isWord(cp)};
+        if ((!anchored_ || p == begin) && add(cur, 0, here)) return true;
+        if (p == end || (anchored_ && cur.size == 0)) return false;
+
+        const char* r = q;
+        const uint32_t after = q != end ? decodeUtf8(r, end) : 0;
+        const Position there{false, q == end, isWord(cp), q != end && isWord(after)};
+        nxt.size = 0;
+        for (size_t k = 0; k < cur.size; ++k) {
+            const Inst& in = prog_[cur.dense[k]];
+            if (in.op == Op::Set && inRanges(sets_[in.x], cp) && add(nxt, cur.dense[k] + 1, there))
+                return true;
+        }
+        std::swap(cur, nxt);
+        wordBefore = isWord(cp);
+        p = q;
+        q = r;
+        cp = after;
+    }
+}
@@ -0,0 +1,53 @@
+#ifndef JSONREGEX_H
+#define JSONREGEX_H
+
+#include <cstdint>
+#include <optional>
+#include <regex>
+#include <string>
+#include <string_view>
+#include <utility>
+#include <vector>
+
+// Regular expressions for the JSON Schema "pattern" keyword. The subset of
+// ECMAScript syntax that JSON Schema recommends (literals, escapes, classes,
+// ., ^, $, \b, groups, alternation and all quantifiers) is compiled for a
+// Pike VM: matching walks the input once, in time proportional to input
+// times pattern length and without recursion, so long strings are safe.
+// Patterns that need backtracking (backreferences, lookaround) fall back to
+// std::regex, which recurses per character; they only accept inputs of up
+// to kMaxBacktrackingInput bytes. Input and pattern are UTF-8 and match by
+// code point. An instance is immutable and may be shared across threads.
+class JsonRegex {
+public:
+    static constexpr size_t kMaxBacktrackingInput = 4096;
+
+    // Throws std::runtime_error for an invalid pattern.
+    explicit JsonRegex(const std::string& pattern);
+
+    // False for input the fallback cannot match safely; search() must then
+    // not be called.
+    bool accepts(std::string_view s) const {
+        return !fallback_ || s.size() <= kMaxBacktrackingInput;
+    }
+    // Whether the pattern matches anywhere in `s`, like std::regex_search.
+    bool search(std::string_view s) const;
+
+private:
+    struct Compiler;   // pattern parser and code generator, in jsonregex.cpp
+
+    enum class Op : uint8_t { Set, Split, Jmp, Match, Begin, End, WordBoundary, NotWordBoundary };
+    struct Inst {
+        Op       op;
+        uint32_t x = 0;         // Split/Jmp target, Set: index into sets_
+        uint32_t y = 0;         // Split: second target
+    };
+    using Ranges = std::vector<std::pair<uint32_t, uint32_t>>;   // sorted, disjoint, inclusive
+
+    std::vector<Inst>   prog_;
+    std::vector<Ranges> sets_;
+    bool                anchored_ = false;   // starts with ^: only tried at offset 0
+    std::optional<std::regex> fallback_;
+};
+
+#endif // JSONREGEX_H
@@ -0,0 +1,457 @@
+#include "jsonschema.h"
+#include <algorithm>
+#include <cmath>
+#include <sstream>
+#include "jsonbind.h"
+#include "jsondiff.h"
+#include "jsonformatter.h"
+
+namespace {
+
+std::string numberText(double d) {
+    std::ostringstream os;
+    printJsonNumber(os, d);
+    return os.str();
+}
+
+size_t utf8Length(std::string_view s) {
+    size_t n = 0;
+    for (char c : s) n += (static_cast<unsigned char>(c) & 0xC0) != 0x80;
+    return n;
+}
+
+std::optional<size_t> sizeKeyword(const JsonObject& o, const char* name, const std::string& path) {
+    auto it = o.find(name);
+    if (it == o.end()) return std::nullopt;
+    if (it->second->getType() != JsonValue::Type::Number || it->second->getNumber() < 0
+        || it->second->getNumber() != std::floor(it->second->getNumber()))
+        throw std::runtime_error("Invalid schema at " + path + "/" + name + ": expected a non-negative integer");
+    return static_cast<size_t>(it->second->getNumber());
+}
+
+std::optional<double> numberKeyword(const JsonObject& o, const char* name, const std::string& path) {
+    auto it = o.find(name);
+    if (it == o.end()) return std::nullopt;
+    if (it->second->getType() != JsonValue::Type::Number)
+        throw std::runtime_error("Invalid schema at " + path + "/" + name + ": expected a number");
+    return it->second->getNumber();
+}
+
+// bit i of a type mask is kTypeNames[i]
+enum TypeBit : unsigned {
+    kNull = 1, kBoolean = 2, kInteger = 4, kNumber = 8, kString = 16, kArray = 32, kObject = 64
+};
+const char* kTypeNames[] = {"null", "boolean", "integer", "number", "string", "array", "object"};
+
+std::string typeList(unsigned types) {
+    std::string s;
+    for (unsigned i = 0; i < 7; ++i) {
+        if (!(types & (1u << i))) continue;
+        if (!s.empty()) s += " or ";
+        s += kTypeNames[i];
+    }
+    return s;
+}
+
+// "Expected <allowed>, got <actual>"; an integral number is reported as integer
+std::string typeMismatch(unsigned allowed, unsigned actual) {
+    if (actual == (kInteger | kNumber)) actual = kInteger;
+    return "Expected " + typeList(allowed) + ", got " + typeList(actual);
+}
+
+} // namespace
+
+/* --------------------------------------------------------------- */
+JsonSchema JsonSchema::compile(const std::shared_ptr<JsonValue>& schema) {
+    JsonSchema s;
+    s.compileNode(schema, "");
+    return s;
+}
+
+JsonSchema JsonSchema::loadFromFile(const std::string& filename) {
+    return compile(JsonParser::loadFromFile(filename));
+}
+
+int JsonSchema::compileNode(const std::shared_ptr<JsonValue>& schema, const std::string& path) {
+    using Type = JsonValue::Type;
+    const std::string where = path.empty() ? "(root)" : path;
+    int idx = static_cast<int>(nodes_.size());
+    nodes_.emplace_back();
+    Node n;
+
+    if (schema && schema->getType() == Type::Bool) {
+        n.never = !schema->getBool();
+        nodes_[idx] = std::move(n);
+        return idx;
+    }
+    if (!schema || schema->getType() != Type::Object)
+        throw std::runtime_error("Invalid schema at " + where + ": expected an object or boolean");
+    const JsonObject& o = schema->getObject();
+
+    if (auto it = o.find("type"); it != o.end()) {
+        auto addType = [&](const std::shared_ptr<JsonValue>& t) {
+            if (t->getType() == Type::String) {
+                for (unsigned i = 0; i < 7; ++i)
+                    if (t->getString() == kTypeNames[i]) { n.types |= 1u << i; return; }
+            }
+            throw std::runtime_error("Invalid schema at " + where + "/type: unknown type");
+        };
+        if (it->second->getType() == Type::Array) for (const auto& t : it->second->getArray()) addType(t);
+        else addType(it->second);
+        if (n.types & kNumber) n.types |= kInteger;    // every integer is a number
+    }
+
+    if (auto it = o.find("properties"); it != o.end()) {
+        if (it->second->getType() != Type::Object)
+            throw std::runtime_error("Invalid schema at " + where + "/properties: expected an object");
+        for (const auto& kv : it->second->getObject()) {
+            std::string sub = path + "/properties";
+            appendJsonPointer(sub, kv.first);
+            int child = compileNode(kv.second, sub);
+            n.properties.push_back({std::string(kv.first), child, false});
+        }
+    }
+    if (auto it = o.find("required"); it != o.end()) {
+        if (it->second->getType() != Type::Array)
+            throw std::runtime_error("Invalid schema at " + where + "/required: expected an array");
+        for (const auto& r : it->second->getArray()) {
+            if (r->getType() != Type::String)
+                throw std::runtime_error("Invalid schema at " + where + "/required: expected strings");
+            auto p = std::find_if(n.properties.begin(), n.properties.end(),
+                                  [&](const Property& q) { return std::string_view(q.name) == r->getString(); });
+            if (p == n.properties.end()) n.properties.push_back({std::string(r->getString()), -1, true});
+            else p->required = true;
+        }
+    }
+    std::sort(n.properties.begin(), n.properties.end(),
+              [](const Property& a, const Property& b) { return a.name < b.name; });
+    for (const auto& p : n.properties) n.requiredCount += p.required;
+
+    if (auto it = o.find("additionalProperties"); it != o.end()) {
+        if (it->second->getType() == Type::Bool && !it->second->getBool()) n.additionalAllowed = false;
+        else n.additional = compileNode(it->second, path + "/additionalProperties");
+    }
+    if (auto it = o.find("items"); it != o.end())
+        n.items = compileNode(it->second, path + "/items");
+
+    auto addEnum = [&](const std::shared_ptr<JsonValue>& v) {
+        n.enumValues.push_back(v);
+        n.enumNeedsDom |= v->getType() == Type::Array || v->getType() == Type::Object;
+    };
+    if (auto it = o.find("enum"); it != o.end()) {
+        if (it->second->getType() != Type::Array)
+            throw std::runtime_error("Invalid schema at " + where + "/enum: expected an array");
+        n.hasEnum = true;
+        for (const auto& v : it->second->getArray()) addEnum(v);
+    }
+    if (auto it = o.find("const"); it != o.end()) {
+        n.hasEnum = true;
+        addEnum(it->second);
+    }
+
+    n.minimum          = numberKeyword(o, "minimum", path);
+    n.maximum          = numberKeyword(o, "maximum", path);
+    n.exclusiveMinimum = numberKeyword(o, "exclusiveMinimum", path);
+    n.exclusiveMaximum = numberKeyword(o, "exclusiveMaximum", path);
+    n.minLength        = sizeKeyword(o, "minLength", path);
+    n.maxLength        = sizeKeyword(o, "maxLength", path);
+    n.minItems         = sizeKeyword(o, "minItems", path);
+    n.maxItems         = sizeKeyword(o, "maxItems", path);
+    n.minProperties    = sizeKeyword(o, "minProperties", path);
+    n.maxProperties    = sizeKeyword(o, "maxProperties", path);
+
+    if (auto it = o.find("pattern"); it != o.end()) {
+        if (it->second->getType() != Type::String)
+            throw std::runtime_error("Invalid schema at " + where + "/pattern: expected a string");
+        n.patternSource = std::string(it->second->getString());
+        try {
+            n.pattern.emplace(n.patternSource);
+        } catch (const std::runtime_error& e) {
+            throw std::runtime_error("Invalid schema at " + where + "/pattern: " + e.what());
+        }
+    }
+
+    nodes_[idx] = std::move(n);
+    return idx;
+}
+
+const JsonSchema::Property* JsonSchema::findProperty(const Node& n, std::string_view name) const {
+    auto it = std::lower_bound(n.properties.begin(), n.properties.end(), name,
+                               [](const Property& p, std::string_view k) { return p.name < k; });
+    return it != n.properties.end() && it->name == name ? &*it : nullptr;
+}
+
+/* --------------------------------------------------------------- */
+void JsonSchema::checkNumber(const Node& n, double d, std::string& path,
+                             std::vector<JsonSchemaError>& out) const {
+    if (n.minimum && d < *n.minimum)
+        out.push_back({path, "Number is below minimum " + numberText(*n.minimum)});
+    if (n.maximum && d > *n.maximum)
+        out.push_back({path, "Number is above maximum " + numberText(*n.maximum)});
+    if (n.exclusiveMinimum && d <= *n.exclusiveMinimum)
+        out.push_back({path, "Number must be greater than " + numberText(*n.exclusiveMinimum)});
+    if (n.exclusiveMaximum && d >= *n.exclusiveMaximum)
+        out.push_back({path, "Number must be less than " + numberText(*n.exclusiveMaximum)});
+}
+
+void JsonSchema::checkString(const Node& n, std::string_view s, std::string& path,
+                             std::vector<JsonSchemaError>& out) const {
+    if (n.minLength || n.maxLength) {
+        size_t len = utf8Length(s);
+        if (n.minLength && len < *n.minLength)
+            out.push_back({path, "String is shorter than minLength " + std::to_string(*n.minLength)});
+        if (n.maxLength && len > *n.maxLength)
+            out.push_back({path, "String is longer than maxLength " + std::to_string(*n.maxLength)});
+    }
+    if (n.pattern && !n.pattern->accepts(s))
+        out.push_back({path, "String is too long for pattern \"" + n.patternSource + "\" (over "
+                             + std::to_string(JsonRegex::kMaxBacktrackingInput) + " bytes)"});
+    else if (n.pattern && !n.pattern->search(s))
+        out.push_back({path, "String does not match pattern \"" + n.patternSource + "\""});
+}
+
+bool JsonSchema::enumHasScalar(const Node& n, JsonValue::Type type, double d, bool b,
+                               std::string_view s) const {
+    using Type = JsonValue::Type;
+    for (const auto& v : n.enumValues) {
+        if (v->getType() != type) continue;
+        switch (type) {
+        case Type::Null:   return true;
+        case Type::Bool:   if (v->getBool() == b) return true; break;
+        case Type::Number: if (v->getNumber() == d) return true; break;
+        case Type::String: if (v->getString() == s) return true; break;
+        default: break;
+        }
+    }
+    return false;
+}
+
+/* --------------------------------------------------------------- */
+void JsonSchema::validateNode(int idx, const std::shared_ptr<JsonValue>& v, std::string& path,
+                              std::vector<JsonSchemaError>& out) const {
+    using Type = JsonValue::Type;
+    const Node& n = nodes_[idx];
+    if (n.never) { out.push_back({path, "No value is allowed here"}); return; }
+
+    const Type type = v ? v->getType() : Type::Null;
+    unsigned bit = 0;
+    switch (type) {
+    case Type::Null:   bit = kNull; break;
+    case Type::Bool:   bit = kBoolean; break;
+    case Type::Number: bit = v->getNumber() == std::floor(v->getNumber()) ? kInteger | kNumber : kNumber; break;
+    case Type::String: bit = kString; break;
+    case Type::Array:  bit = kArray; break;
+    case Type::Object: bit = kObject; break;
+    }
+    if (n.types && !(n.types & bit)) {
+        out.push_back({path, typeMismatch(n.types, bit)});
+        return;
+    }
+
+    if (n.hasEnum) {
+        bool found;
+        if (type == Type::Array || type == Type::Object) {
+            found = std::any_of(n.enumValues.begin(), n.enumValues.end(),
+                                [&](const auto& e) { return diffJson(e, v).empty(); });
+        } else {
+            found = enumHasScalar(n, type, type == Type::Number ? v->getNumber() : 0,
+                                  type == Type::Bool && v->getBool(),
+                                  type == Type::String ? std::string_view(v->getString()) : std::string_view());
+        }
+        if (!found) out.push_back({path, "Value is not in enum"});
+    }
+
+    switch (type) {
+    case Type::Number: checkNumber(n, v->getNumber(), path, out); break;
+    case Type::String: checkString(n, v->getString(), path, out); break;
+    case Type::Array: {
+        const auto& a = v->getArray();
+        if (n.minItems && a.size() < *n.minItems)
+            out.push_back({path, "Array has fewer than " + std::to_string(*n.minItems) + " items"});
+        if (n.maxItems && a.size() > *n.maxItems)
+            out.push_back({path, "Array has more than " + std::to_string(*n.maxItems) + " items"});
+        if (n.items < 0) break;
+        for (size_t i = 0; i < a.size(); ++i) {
+            size_t len = path.size();
+            appendJsonPointer(path, std::to_string(i));
+            validateNode(n.items, a[i], path, out);
+            path.resize(len);
+        }
+        break;
+    }
+    case Type::Object: {
+        const auto& o = v->getObject();
+        if (n.minProperties && o.size() < *n.minProperties)
+            out.push_back({path, "Object has fewer than " + std::to_string(*n.minProperties) + " properties"});
+        if (n.maxProperties && o.size() > *n.maxProperties)
+            out.push_back({path, "Object has more than " + std::to_string(*n.maxProperties) + " properties"});
+        for (const auto& p : n.properties) {
+            if (p.required && !o.count(JsonString(p.name)))
+                out.push_back({path, "Missing required property \"" + p.name + "\""});
+        }
+        for (const auto& kv : o) {
+            const Property* p = findProperty(n, kv.first);
+            int child = p ? p->schema : n.additional;
+            if (!p && !n.additionalAllowed) {
+                size_t len = path.size();
+                appendJsonPointer(path, kv.first);
+                out.push_back({path, "Property is not allowed"});
+                path.resize(len);
+            } else if (child >= 0) {
+                size_t len = path.size();
+                appendJsonPointer(path, kv.first);
+                validateNode(child, kv.second, path, out);
+                path.resize(len);
+            }
+        }
+        break;
+    }
+    default: break;
+    }
+}
+
+/* --------------------------------------------------------------- */
+void JsonSchema::validateStream(int idx, JsonReader& in, std::string& path,
+                                std::vector<JsonSchemaError>& out) const {
+    using Type = JsonValue::Type;
+    const Node& n = nodes_[idx];
+    if (n.never) { out.push_back({path, "No value is allowed here"}); in.skipValue(); return; }
+    if (n.enumNeedsDom) {
+        // comparing against container enum values needs the value itself
+        std::string_view text = in.skipValue();
+        validateNode(idx, JsonParser::parse(std::string(text)), path, out);
+        return;
+    }
+
+    auto typeMatches = [&](unsigned bit) {
+        if (!n.types || (n.types & bit)) return true;
+        out.push_back({path, typeMismatch(n.types, bit)});
+        return false;
+    };
+
+    switch (in.peek()) {
+    case '{': {
+        if (!typeMatches(kObject)) { in.skipValue(); return; }
+        if (n.hasEnum) out.push_back({path, "Value is not in enum"});
+        // seen flags for required properties, on the stack for the usual sizes
+        uint64_t seenSmall = 0;
+        std::vector<char> seenBig(n.properties.size() > 64 ? n.properties.size() : 0);
+        std::string scratch;
+        size_t count = 0;
+
+        in.expect('{');
+        if (!in.consume('}')) {
+            do {
+                std::string_view key = in.readKey(scratch);
+                in.expect(':');
+                ++count;
+                const Property* p = findProperty(n, key);
+                size_t len = path.size();
+                appendJsonPointer(path, key);
+                if (p) {
+                    size_t i = static_cast<size_t>(p - n.properties.data());
+                    if (seenBig.empty()) seenSmall |= uint64_t(1) << i;
+                    else seenBig[i] = 1;
+                    if (p->schema >= 0) validateStream(p->schema, in, path, out);
+                    else in.skipValue();
+                } else if (!n.additionalAllowed) {
+                    out.push_back({path, "Property is not allowed"});
+                    in.skipValue();
+                } else if (n.additional >= 0) {
+                    validateStream(n.additional, in, path, out);
+                } else {
+                    in.skipValue();
+                }
+                path.resize(len);
+            } while (in.consume(','));
+            in.expect('}');
+        }
+
+        if (n.minProperties && count < *n.minProperties)
+            out.push_back({path, "Object has fewer than " + std::to_string(*n.minProperties) + " properties"});
+        if (n.maxProperties && count > *n.maxProperties)
+            out.push_back({path, "Object has more than " + std::to_string(*n.maxProperties) + " properties"});
+        if (n.requiredCount) {
+            for (size_t i = 0; i < n.properties.size(); ++i) {
+                bool seen = seenBig.empty() ? (seenSmall >> i) & 1 : seenBig[i];
+                if (n.properties[i].required && !seen)
+                    out.push_back({path, "Missing required property \"" + n.properties[i].name + "\""});
+            }
+        }
+        return;
+    }
+    case '[': {
+        if (!typeMatches(kArray)) { in.skipValue(); return; }
+        if (n.hasEnum) out.push_back({path, "Value is not in enum"});
+        size_t count = 0;
+        in.expect('[');
+        if (!in.consume(']')) {
+            do {
+                if (n.items >= 0) {
+                    size_t len = path.size();
+                    appendJsonPointer(path, std::to_string(count));
+                    validateStream(n.items, in, path, out);
+                    path.resize(len);
+                } else {
+                    in.skipValue();
+                }
+                ++count;
+            } while (in.consume(','));
+            in.expect(']');
+        }
+        if (n.minItems && count < *n.minItems)
+            out.push_back({path, "Array has fewer than " + std::to_string(*n.minItems) + " items"});
+        if (n.maxItems && count > *n.maxItems)
+            out.push_back({path, "Array has more than " + std::to_string(*n.maxItems) + " items"});
+        return;
+    }
+    case '"': {
+        if (!typeMatches(kString)) { in.skipValue(); return; }
+        std::string scratch;
+        std::string_view s = in.readKey(scratch);   // a view when there are no escapes
+        if (n.hasEnum && !enumHasScalar(n, Type::String, 0, false, s))
+            out.push_back({path, "Value is not in enum"});
+        checkString(n, s, path, out);
+        return;
+    }
+    case 't': case 'f': {
+        bool b = in.readBool();
+        if (typeMatches(kBoolean) && n.hasEnum && !enumHasScalar(n, Type::Bool, 0, b, {}))
+            out.push_back({path, "Value is not in enum"});
+        return;
+    }
+    case '\0':
+        in.skipValue();   // reports the end of input
+        return;
+    case 'n':
+        in.readNull();
+        if (typeMatches(kNull) && n.hasEnum && !enumHasScalar(n, Type::Null, 0, false, {}))
+            out.push_back({path, "Value is not in enum"});
+        return;
+    default: {
+        double d = in.readNumber();
+        if (!typeMatches(d == std::floor(d) ? kInteger | kNumber : kNumber)) return;
+        if (n.hasEnum && !enumHasScalar(n, Type::Number, d, false, {}))
+            out.push_back({path, "Value is not in enum"});
+        checkNumber(n, d, path, out);
+        return;
+    }
+    }
+}
+
+/* --------------------------------------------------------------- */
+std::vector<JsonSchemaError> JsonSchema::validate(const std::shared_ptr<JsonValue>& doc) const {
+    std::vector<JsonSchemaError> out;
+    std::string path;
+    validateNode(0, doc, path, out);
+    return out;
+}
+
+std::vector<JsonSchemaError> JsonSchema::validate(std::string_view text) const {
+    std::vector<JsonSchemaError> out;
+    std::string path;
+    JsonReader in(text);
+    validateStream(0, in, path, out);
+    in.finish();
+    return out;
+}
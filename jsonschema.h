@@ -0,0 +1,77 @@
+#ifndef JSONSCHEMA_H
+#define JSONSCHEMA_H
+
+#include <cstdint>
+#include <memory>
+#include <optional>
+#include <string>
+#include <string_view>
+#include <utility>
+#include <vector>
+#include "jsonparser.h"
+#include "jsonregex.h"
+
+class JsonReader;
+
+struct JsonSchemaError {
+    std::string path;       // JSON Pointer of the offending value ("" is the root)
+    std::string message;
+};
+
+// A JSON Schema compiled for repeated validation. Supported keywords (draft
+// 2020-12 core subset): type, properties, required, additionalProperties,
+// items, enum, const, minimum, maximum, exclusiveMinimum, exclusiveMaximum,
+// minLength, maxLength, pattern, minItems, maxItems, minProperties,
+// maxProperties, and the boolean schemas true/false. Other keywords are
+// ignored. A compiled schema is immutable and may be shared across threads.
+class JsonSchema {
+public:
+    static JsonSchema compile(const std::shared_ptr<JsonValue>& schema);
+    static JsonSchema loadFromFile(const std::string& filename);
+
+    // Validate a parsed document.
+    std::vector<JsonSchemaError> validate(const std::shared_ptr<JsonValue>& doc) const;
+    // Validate JSON text as it is read, without building a DOM. Syntax errors
+    // throw std::runtime_error like the parser.
+    std::vector<JsonSchemaError> validate(std::string_view text) const;
+
+private:
+    struct Property {
+        std::string name;
+        int  schema = -1;       // node index, -1: any value
+        bool required = false;
+    };
+
+    struct Node {
+        bool     never = false;            // the `false` schema
+        unsigned types = 0;                // mask of type bits, 0: any type
+        std::vector<Property> properties;  // sorted by name
+        size_t   requiredCount = 0;
+        bool     additionalAllowed = true;
+        int      additional = -1;          // schema for other properties
+        int      items = -1;
+        std::vector<std::shared_ptr<JsonValue>> enumValues;
+        bool     hasEnum = false;
+        bool     enumNeedsDom = false;     // enum lists a container value
+        std::optional<double> minimum, maximum, exclusiveMinimum, exclusiveMaximum;
+        std::optional<size_t> minLength, maxLength, minItems, maxItems, minProperties, maxProperties;
+        std::optional<JsonRegex> pattern;
+        std::string patternSource;
+    };
+
+    int compileNode(const std::shared_ptr<JsonValue>& schema, const std::string& path);
+    const Property* findProperty(const Node& n, std::string_view name) const;
+
+    void checkNumber(const Node& n, double d, std::string& path, std::vector<JsonSchemaError>& out) const;
+    void checkString(const Node& n, std::string_view s, std::string& path, std::vector<JsonSchemaError>& out) const;
+    bool enumHasScalar(const Node& n, JsonValue::Type type, double d, bool b, std::string_view s) const;
+
+    void validateNode(int idx, const std::shared_ptr<JsonValue>& v, std::string& path,
+                      std::vector<JsonSchemaError>& out) const;
+    void validateStream(int idx, JsonReader& in, std::string& path,
+                        std::vector<JsonSchemaError>& out) const;
+
+    std::vector<Node> nodes_;
+};
+
+#endif // JSONSCHEMA_H
@@ -0,0 +1,425 @@
+#include "jsonserver.h"
+#include <algorithm>
+#include <cerrno>
+#include <condition_variable>
+#include <csignal>
+#include <cstring>
+#include <deque>
+#include <memory_resource>
+#include <optional>
+#include <sstream>
+#include <stdexcept>
+#include <vector>
+#include "jsonbind.h"
+#include "jsoncompress.h"
+#include "jsonformatter.h"
+#include "jsonlinter.h"
+#include "jsonpointer.h"
+#include "threadpool.h"
+
+#ifndef _WIN32
+#  include <fcntl.h>
+#  include <poll.h>
+#  include <sys/socket.h>
+#  include <sys/stat.h>
+#  include <sys/un.h>
+#  include <unistd.h>
+#endif
+
+namespace fs = std::filesystem;
+
+// A parsed document. The arena is declared before the root so that the tree
+// is released before the memory it lives in.
+struct JsonServer::Document {
+    std::string text;
+    std::pmr::monotonic_buffer_resource arena;
+    std::shared_ptr<JsonValue> root;
+
+    const std::vector<JsonLintIssue>& lint() {
+        std::call_once(lintOnce_, [this] { issues_ = lintJson(root, text); });
+        return issues_;
+    }
+
+private:
+    std::once_flag lintOnce_;
+    std::vector<JsonLintIssue> issues_;
+};
+
+namespace {
+
+struct ServeRequest {
+    std::optional<long long> id;
+    std::string op;
+    std::optional<std::string> path, content, pointer;
+    std::optional<bool> jsonc, compact;
+    std::optional<int> indent;
+};
+
+// A client could otherwise ask for gigabytes of padding per line.
+const int kMaxIndent = 16;
+
+const char* severityName(JsonLintIssue::Severity s) {
+    switch (s) {
+        case JsonLintIssue::Severity::Error:   return "error";
+        case JsonLintIssue::Severity::Warning: return "warning";
+        case JsonLintIssue::Severity::Info:    return "info";
+    }
+    return "error";
+}
+
+} // namespace
+
+template <> struct JsonBinding<ServeRequest> {
+    static constexpr auto fields = std::make_tuple(
+        jsonField("id",      &ServeRequest::id),
+        jsonField("op",      &ServeRequest::op),
+        jsonField("path",    &ServeRequest::path),
+        jsonField("content", &ServeRequest::content),
+        jsonField("pointer", &ServeRequest::pointer),
+        jsonField("jsonc",   &ServeRequest::jsonc),
+        jsonField("compact", &ServeRequest::compact),
+        jsonField("indent",  &ServeRequest::indent));
+};
+
+JsonServer::JsonServer(ThreadPool& pool, JsonServerOptions opt) : pool_(pool), opt_(opt) {}
+
+JsonServer::~JsonServer() = default;
+
+size_t JsonServer::cachedDocuments() const {
+    std::lock_guard<std::mutex> lock(mutex_);
+    return cache_.size();
+}
+
+/* --------------------------------------------------------------- */
+std::shared_ptr<JsonServer::Document> JsonServer::parseDocument(std::string text, bool jsonc) const {
+    auto doc = std::make_shared<Document>();
+    doc->text = std::move(text);
+    doc->root = jsonc ? JsoncParser::parse(doc->text, &doc->arena)
+                      : JsonParser::parse(doc->text, &doc->arena);
+    return doc;
+}
+
+// Documents are keyed by absolute path and dialect. A cached entry is used
+// while the file's mtime and size are unchanged; parsing happens outside the
+// lock, so two clients asking for the same cold file may both parse it.
+std::shared_ptr<JsonServer::Document> JsonServer::load(const std::string& path, bool jsonc) {
+    std::error_code ec;
+    fs::path abs = fs::absolute(path, ec);
+    if (ec) throw std::runtime_error("Cannot open " + path);
+    auto mtime = fs::last_write_time(abs, ec);
+    uintmax_t size = ec ? 0 : fs::file_size(abs, ec);
+    if (ec) throw std::runtime_error("Cannot open " + path);
+    std::string key = (jsonc ? "c:" : "j:") + abs.string();
+
+    {
+        std::lock_guard<std::mutex> lock(mutex_);
+        auto it = cache_.find(key);
+        if (it != cache_.end() && it->second.mtime == mtime && it->second.size == size) {
+            lru_.splice(lru_.begin(), lru_, it->second.lru);
+            return it->second.doc;
+        }
+    }
+
+    auto doc = parseDocument(readJsonInput(abs.string()), jsonc);
+    if (doc->text.size() > opt_.cacheBytes) return doc;
+
+    std::lock_guard<std::mutex> lock(mutex_);
+    auto it = cache_.find(key);
+    if (it != cache_.end()) {
+        cachedBytes_ -= it->second.doc->text.size();
+        lru_.erase(it->second.lru);
+        cache_.erase(it);
+    }
+    lru_.push_front(key);
+    cache_.emplace(key, CacheEntry{mtime, size, doc, lru_.begin()});
+    cachedBytes_ += doc->text.size();
+    while (cachedBytes_ > opt_.cacheBytes) {
+        auto victim = cache_.find(lru_.back());
+        cachedBytes_ -= victim->second.doc->text.size();
+        cache_.erase(victim);
+        lru_.pop_back();
+    }
+    return doc;
+}
+
+/* --------------------------------------------------------------- */
+std::string JsonServer::handle(std::string_view request) {
+    std::ostringstream os;
+    ServeRequest req;
+    try {
+        fromJson(request, req);
+    } catch (const std::exception& e) {
+        os << "{\"ok\":false,\"error\":";
+        printJsonString(os, std::string("Bad request: ") + e.what());
+        os << '}';
+        return os.str();
+    }
+
+    os << '{';
+    if (req.id) os << "\"id\":" << *req.id << ',';
+    try {
+        std::ostringstream body;
+        if (req.op == "ping") {
+            // nothing to add
+        } else if (req.op == "shutdown") {
+            stop();
+        } else if (req.op == "lint" || req.op == "format" || req.op == "query") {
+            bool jsonc = req.jsonc.value_or(opt_.jsonc);
+            std::shared_ptr<Document> doc;
+            if (req.content)   doc = parseDocument(std::move(*req.content), jsonc);
+            else if (req.path) doc = load(*req.path, jsonc);
+            else throw std::runtime_error("Request needs \"path\" or \"content\"");
+
+            if (req.op == "lint") {
+                body << ",\"issues\":[";
+                const auto& issues = doc->lint();
+                for (size_t i = 0; i < issues.size(); ++i) {
+                    const auto& iss = issues[i];
+                    if (i) body << ',';
+                    body << "{\"severity\":\"" << severityName(iss.severity) << "\",\"message\":";
+                    printJsonString(body, iss.message);
+                    if (iss.line != -1) body << ",\"line\":" << iss.line << ",\"column\":" << iss.column;
+                    body << '}';
+                }
+                body << ']';
+            } else if (req.op == "format") {
+                int indent = req.indent.value_or(opt_.indent);
+                if (indent < 0 || indent > kMaxIndent)
+                    throw std::runtime_error("\"indent\" must be between 0 and " + std::to_string(kMaxIndent));
+                std::ostringstream text;
+                printJson(doc->root, text, 0, indent, req.compact.value_or(false));
+                body << ",\"output\":";
+                printJsonString(body, text.str());
+            } else {
+                auto value = resolveJsonPointer(doc->root, req.pointer.value_or(""));
+                body << ",\"value\":";
+                printJson(value, body, 0, 2, true);
+            }
+        } else {
+            throw std::runtime_error("Unknown op \"" + req.op + "\"");
+        }
+        os << "\"ok\":true" << body.str() << '}';
+    } catch (const std::exception& e) {
+        os << "\"ok\":false,\"error\":";
+        printJsonString(os, e.what());
+        os << '}';
+    }
+    return os.str();
+}
+
+/* --------------------------------------------------------------- */
+#ifdef _WIN32
+
+void JsonServer::serve(const std::string&) {
+    throw std::runtime_error("--serve needs Unix domain sockets, which this platform does not provide");
+}
+
+#else
+
+namespace {
+
+// One request's response, filled in by a pool task and written by serve().
+struct Reply {
+    std::string text;
+    bool ready = false;
+};
+
+struct Connection {
+    int fd;
+    std::string in;                               // start of an unfinished request line
+    std::string out;                              // responses not yet written
+    size_t written = 0;                           // bytes of `out` already sent
+    std::deque<std::shared_ptr<Reply>> replies;   // requests in flight, in order
+    bool eof = false;                             // the client has stopped sending
+    bool failed = false;                          // read or write error: drop it
+};
+
+// Requests a client may have in flight before the server stops reading from it.
+const size_t kMaxInFlight = 64;
+
+bool setNonBlocking(int fd) {
+    int flags = ::fcntl(fd, F_GETFL, 0);
+    return flags >= 0 && ::fcntl(fd, F_SETFL, flags | O_NONBLOCK) == 0;
+}
+
+// Writes what the socket takes without blocking; `wait` bounds how long to
+// wait for room in milliseconds (0: not at all).
+void flush(Connection& c, int wait) {
+    while (c.written < c.out.size()) {
+        ssize_t w = ::write(c.fd, c.out.data() + c.written, c.out.size() - c.written);
+        if (w >= 0) { c.written += static_cast<size_t>(w); continue; }
+        if (errno == EINTR) continue;
+        if (errno == EAGAIN || errno == EWOULDBLOCK) {
+            pollfd pfd{c.fd, POLLOUT, 0};
+            if (wait > 0 && ::poll(&pfd, 1, wait) > 0) continue;
+            return;
+        }
+        c.failed = true;
+        return;
+    }
+    c.out.clear();
+    c.written = 0;
+}
+
+} // namespace
+
+void JsonServer::serve(const std::string& socketPath) {
+    sockaddr_un addr{};
+    addr.sun_family = AF_UNIX;
+    if (socketPath.size() >= sizeof addr.sun_path)
+        throw std::runtime_error("Socket path is too long: " + socketPath);
+    std::memcpy(addr.sun_path, socketPath.c_str(), socketPath.size() + 1);
+
+    // A socket file left behind by a previous server would make bind() fail.
+    // One that still accepts connections belongs to a running server.
+    struct stat st;
+    if (::lstat(socketPath.c_str(), &st) == 0 && S_ISSOCK(st.st_mode)) {
+        int probe = ::socket(AF_UNIX, SOCK_STREAM, 0);
+        bool live = probe >= 0 && ::connect(probe, reinterpret_cast<sockaddr*>(&addr), sizeof addr) == 0;
+        if (probe >= 0) ::close(probe);
+        if (live) throw std::runtime_error("Another server is listening on " + socketPath);
+        ::unlink(socketPath.c_str());
+    }
+
+    int listener = ::socket(AF_UNIX, SOCK_STREAM, 0);
+    if (listener < 0) throw std::runtime_error(std::string("socket: ") + std::strerror(errno));
+    if (::bind(listener, reinterpret_cast<sockaddr*>(&addr), sizeof addr) != 0 || ::listen(listener, 64) != 0
+        || !setNonBlocking(listener)) {
+        std::string err = std::strerror(errno);
+        ::close(listener);
+        throw std::runtime_error("Cannot listen on " + socketPath + ": " + err);
+    }
+    // Finished tasks write a byte here so that poll() picks up their replies.
+    int wake[2];
+    if (::pipe(wake) != 0 || !setNonBlocking(wake[0]) || !setNonBlocking(wake[1])) {
+        std::string err = std::strerror(errno);
+        ::close(listener);
+        ::unlink(socketPath.c_str());
+        throw std::runtime_error("pipe: " + err);
+    }
+    std::signal(SIGPIPE, SIG_IGN);   // a client hanging up must not end the server
+
+    std::mutex              replyMutex;   // guards Reply and inFlight
+    std::condition_variable idle;
+    size_t                  inFlight = 0;
+    std::vector<std::unique_ptr<Connection>> conns;
+    std::vector<pollfd> fds;
+    std::vector<char> chunk(64 * 1024);
+
+    auto submit = [&](Connection& c, std::string line) {
+        auto reply = std::make_shared<Reply>();
+        c.replies.push_back(reply);
+        {
+            std::lock_guard<std::mutex> lock(replyMutex);
+            ++inFlight;
+        }
+        pool_.submit([&, reply, line = std::move(line), wakeFd = wake[1]] {
+            std::string text = handle(line);
+            {
+                std::lock_guard<std::mutex> lock(replyMutex);
+                reply->text = std::move(text);
+                reply->ready = true;
+            }
+            char b = 0;
+            if (::write(wakeFd, &b, 1) < 0) {}   // a full pipe already has a wake-up pending
+            std::lock_guard<std::mutex> lock(replyMutex);
+            --inFlight;
+            idle.notify_all();   // under the lock: serve() may return once it sees 0
+        });
+    };
+
+    // Queues the replies that are ready, in request order, behind `out`.
+    auto collect = [&](Connection& c) {
+        std::lock_guard<std::mutex> lock(replyMutex);
+        while (!c.replies.empty() && c.replies.front()->ready) {
+            c.out += c.replies.front()->text;
+            c.out += '\n';
+            c.replies.pop_front();
+        }
+    };
+
+    auto receive = [&](Connection& c) {
+        ssize_t n = ::read(c.fd, chunk.data(), chunk.size());
+        if (n < 0) {
+            if (errno != EINTR && errno != EAGAIN && errno != EWOULDBLOCK) c.failed = true;
+            return;
+        }
+        if (n == 0) { c.eof = true; return; }
+        c.in.append(chunk.data(), static_cast<size_t>(n));
+        size_t start = 0, nl;
+        while ((nl = c.in.find('\n', start)) != std::string::npos) {
+            std::string_view line(c.in.data() + start, nl - start);
+            start = nl + 1;
+            if (!line.empty() && line.back() == '\r') line.remove_suffix(1);
+            if (line.find_first_not_of(" \t") == std::string_view::npos) continue;
+            submit(c, std::string(line));
+        }
+        c.in.erase(0, start);
+        if (c.in.size() > opt_.maxRequestBytes) {
+            // A missing newline must not grow `in` without bound.
+            auto reply = std::make_shared<Reply>();
+            reply->text = "{\"ok\":false,\"error\":\"Request line is longer than "
+                        + std::to_string(opt_.maxRequestBytes) + " bytes\"}";
+            reply->ready = true;
+            c.replies.push_back(std::move(reply));
+            c.in.clear();
+            c.in.shrink_to_fit();
+            c.eof = true;   // stop reading; close once the replies are out
+        }
+    };
+
+    while (!stopping_) {
+        fds.clear();
+        fds.push_back({listener, POLLIN, 0});
+        fds.push_back({wake[0], POLLIN, 0});
+        for (const auto& c : conns) {
+            short events = 0;
+            if (!c->eof && c->replies.size() < kMaxInFlight) events |= POLLIN;
+            if (c->written < c->out.size()) events |= POLLOUT;
+            fds.push_back({events ? c->fd : -1, events, 0});   // -1: not polled, nor its hang-up
+        }
+        if (::poll(fds.data(), fds.size(), 100) < 0) continue;   // EINTR: re-check the stop flag
+
+        if (fds[1].revents & POLLIN) {
+            char drain[256];
+            while (::read(wake[0], drain, sizeof drain) > 0) {}
+        }
+        for (size_t i = 0; i < conns.size(); ++i) {
+            Connection& c = *conns[i];
+            if (fds[i + 2].revents & (POLLIN | POLLHUP | POLLERR)) receive(c);
+            collect(c);
+            if (!c.failed) flush(c, 0);
+        }
+        conns.erase(std::remove_if(conns.begin(), conns.end(), [](const std::unique_ptr<Connection>& c) {
+            bool done = c->failed || (c->eof && c->replies.empty() && c->out.empty());
+            if (done) ::close(c->fd);
+            return done;
+        }), conns.end());
+
+        if (fds[0].revents & POLLIN) {
+            int client;
+            while ((client = ::accept(listener, nullptr, nullptr)) >= 0) {
+                if (!setNonBlocking(client)) { ::close(client); continue; }
+                conns.push_back(std::make_unique<Connection>(Connection{client, {}, {}, 0, {}, false, false}));
+            }
+        }
+    }
+    ::close(listener);
+    ::unlink(socketPath.c_str());
+
+    // Let the requests in flight finish and deliver their replies (the
+    // "shutdown" acknowledgement among them), giving each client a moment.
+    {
+        std::unique_lock<std::mutex> lock(replyMutex);
+        idle.wait(lock, [&] { return inFlight == 0; });
+    }
+    for (auto& c : conns) {
+        collect(*c);
+        if (!c->failed) flush(*c, 100);
+        ::close(c->fd);
+    }
+    ::close(wake[0]);
+    ::close(wake[1]);
+}
+
+#endif
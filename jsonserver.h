@@ -0,0 +1,83 @@
+#ifndef JSONSERVER_H
+#define JSONSERVER_H
+
+#include <atomic>
+#include <cstddef>
+#include <filesystem>
+#include <list>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <string_view>
+#include <unordered_map>
+
+class ThreadPool;
+
+struct JsonServerOptions {
+    size_t cacheBytes = size_t(256) << 20;        // source bytes of parsed documents kept warm
+    size_t maxRequestBytes = size_t(256) << 20;   // longer request lines end the connection
+    int    indent = 2;                            // request defaults
+    bool   jsonc = false;
+};
+
+// Long-running request server behind `jsonify --serve`. Requests and
+// responses are single-line JSON objects (one per line, in order):
+//
+//   {"id": 1, "op": "lint",   "path": "a.json"}
+//   {"id": 2, "op": "format", "content": "[1,2]", "compact": true}
+//   {"id": 3, "op": "query",  "path": "a.json", "pointer": "/users/0"}
+//   -> {"id": 1, "ok": true, "issues": [...]}  /  {"id": 3, "ok": false, "error": "..."}
+//
+// Other request fields: "jsonc", "indent" (0 to 16); ops "ping" and
+// "shutdown". A request line over `maxRequestBytes` is answered with an
+// error and the connection is closed; documents nested deeper than
+// JsonParser::kMaxDepth are rejected like any other parse error.
+// Documents named by path stay parsed (with their lint results) until the
+// file's mtime or size changes or they are evicted, least recently used
+// first, once `cacheBytes` is exceeded.
+class JsonServer {
+public:
+    explicit JsonServer(ThreadPool& pool, JsonServerOptions opt = JsonServerOptions());
+    ~JsonServer();
+    JsonServer(const JsonServer&) = delete;
+    JsonServer& operator=(const JsonServer&) = delete;
+
+    // Answers one request line; thread-safe. The response has no newline.
+    std::string handle(std::string_view request);
+
+    // Listens on a Unix domain socket until stop() or a "shutdown" request.
+    // Connections are multiplexed with poll() on the calling thread and every
+    // request line is handled by its own pool task, so idle clients hold no
+    // worker; each connection still gets its responses in request order.
+    // Throws if another server is listening on `socketPath`; a stale socket
+    // file is replaced.
+    void serve(const std::string& socketPath);
+
+    // Async-signal-safe: only sets a flag that serve() polls.
+    void stop() { stopping_ = true; }
+
+    size_t cachedDocuments() const;
+
+private:
+    struct Document;
+    struct CacheEntry {
+        std::filesystem::file_time_type mtime;
+        uintmax_t size;
+        std::shared_ptr<Document> doc;
+        std::list<std::string>::iterator lru;
+    };
+
+    std::shared_ptr<Document> load(const std::string& path, bool jsonc);
+    std::shared_ptr<Document> parseDocument(std::string text, bool jsonc) const;
+
+    ThreadPool&       pool_;
+    JsonServerOptions opt_;
+    std::atomic<bool> stopping_{false};
+
+    mutable std::mutex mutex_;          // guards the document cache
+    std::unordered_map<std::string, CacheEntry> cache_;
+    std::list<std::string> lru_;        // most recently used first
+    size_t cachedBytes_ = 0;
+};
+
+#endif // JSONSERVER_H
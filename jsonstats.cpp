@@ -0,0 +1,181 @@
+#include "jsonstats.h"
+#include <cstdio>
+
+#ifdef _WIN32
+#  ifndef NOMINMAX
+#    define NOMINMAX
+#  endif
+#  include <windows.h>
+#  include <psapi.h>
+#else
+#  include <sys/resource.h>
+#  include <time.h>
+#endif
+
+static const char* const TYPE_NAMES[6] = {"null", "bool", "number", "string", "array", "object"};
+
+/* --------------------------------------------------------------- */
+JsonStats::Phase& JsonStats::phase(const std::string& name) {
+    for (auto& p : phases)
+        if (p.name == name) return p;
+    phases.push_back(Phase{name});
+    return phases.back();
+}
+
+static void countRec(const std::shared_ptr<JsonValue>& v, size_t depth, JsonStats& s) {
+    if (depth > s.maxDepth) s.maxDepth = depth;
+    if (!v) { ++s.nodesByType[0]; return; }
+    ++s.nodesByType[static_cast<int>(v->getType())];
+    if (v->getType() == JsonValue::Type::Array) {
+        for (const auto& el : v->getArray()) countRec(el, depth + 1, s);
+    } else if (v->getType() == JsonValue::Type::Object) {
+        for (const auto& kv : v->getObject()) countRec(kv.second, depth + 1, s);
+    }
+}
+
+uint64_t JsonStats::addDocument(const std::shared_ptr<JsonValue>& root) {
+    uint64_t before = totalNodes();
+    countRec(root, 0, *this);
+    return totalNodes() - before;
+}
+
+void JsonStats::merge(const JsonStats& other) {
+    for (const auto& p : other.phases) {
+        Phase& mine = phase(p.name);
+        mine.wallSeconds += p.wallSeconds;
+        mine.cpuSeconds  += p.cpuSeconds;
+        mine.bytes       += p.bytes;
+        mine.nodes       += p.nodes;
+    }
+    for (int i = 0; i < 6; ++i) nodesByType[i] += other.nodesByType[i];
+    if (other.maxDepth > maxDepth) maxDepth = other.maxDepth;
+    files += other.files;
+}
+
+uint64_t JsonStats::totalNodes() const {
+    uint64_t n = 0;
+    for (uint64_t c : nodesByType) n += c;
+    return n;
+}
+
+/* --------------------------------------------------------------- */
+PhaseTimer::PhaseTimer(JsonStats* stats, const char* name, uint64_t bytes)
+    : stats_(stats), name_(name), bytes_(bytes) {
+    if (!stats_) return;
+    wall0_ = std::chrono::steady_clock::now();
+    cpu0_  = threadCpuSeconds();
+}
+
+PhaseTimer::~PhaseTimer() {
+    if (!stats_) return;
+    JsonStats::Phase& p = stats_->phase(name_);
+    p.wallSeconds += std::chrono::duration<double>(std::chrono::steady_clock::now() - wall0_).count();
+    p.cpuSeconds  += threadCpuSeconds() - cpu0_;
+    p.bytes       += bytes_;
+    p.nodes       += nodes_;
+}
+
+/* --------------------------------------------------------------- */
+double processCpuSeconds() {
+#ifdef _WIN32
+    FILETIME created, exited, kernel, user;
+    if (!GetProcessTimes(GetCurrentProcess(), &created, &exited, &kernel, &user)) return 0;
+    auto toSeconds = [](const FILETIME& ft) {
+        ULARGE_INTEGER v;
+        v.LowPart = ft.dwLowDateTime;
+        v.HighPart = ft.dwHighDateTime;
+        return static_cast<double>(v.QuadPart) * 1e-7;   // 100 ns ticks
+    };
+    return toSeconds(kernel) + toSeconds(user);
+#else
+    struct rusage ru;
+    if (getrusage(RUSAGE_SELF, &ru) != 0) return 0;
+    return ru.ru_utime.tv_sec + ru.ru_stime.tv_sec
+         + (ru.ru_utime.tv_usec + ru.ru_stime.tv_usec) * 1e-6;
+#endif
+}
+
+double threadCpuSeconds() {
+#ifdef _WIN32
+    FILETIME created, exited, kernel, user;
+    if (!GetThreadTimes(GetCurrentThread(), &created, &exited, &kernel, &user)) return 0;
+    auto toSeconds = [](const FILETIME& ft) {
+        ULARGE_INTEGER v;
+        v.LowPart = ft.dwLowDateTime;
+        v.HighPart = ft.dwHighDateTime;
+        return static_cast<double>(v.QuadPart) * 1e-7;   // 100 ns ticks
+    };
+    return toSeconds(kernel) + toSeconds(user);
+#else
+    struct timespec ts;
+    if (clock_gettime(CLOCK_THREAD_CPUTIME_ID, &ts) != 0) return 0;
+    return ts.tv_sec + ts.tv_nsec * 1e-9;
+#endif
+}
+
+long peakRssKb() {
+#ifdef _WIN32
+    PROCESS_MEMORY_COUNTERS pmc;
+    if (!K32GetProcessMemoryInfo(GetCurrentProcess(), &pmc, sizeof pmc)) return -1;
+    return static_cast<long>(pmc.PeakWorkingSetSize / 1024);
+#else
+    struct rusage ru;
+    if (getrusage(RUSAGE_SELF, &ru) != 0) return -1;
+#  ifdef __APPLE__
+    return ru.ru_maxrss / 1024;   // bytes on macOS
+#  else
+    return ru.ru_maxrss;          // kilobytes on Linux
+#  endif
+#endif
+}
+
+/* --------------------------------------------------------------- */
+static double perSecond(uint64_t n, double seconds) {
+    return seconds > 0 ? n / seconds : 0;
+}
+
+void printStats(const JsonStats& stats, std::ostream& os, bool json,
+                double wallSeconds, double cpuSeconds, uint64_t allocations) {
+    char line[256];
+    if (json) {
+        os << "{\"files\":" << stats.files << ",\"phases\":[";
+        for (size_t i = 0; i < stats.phases.size(); ++i) {
+            const auto& p = stats.phases[i];
+            std::snprintf(line, sizeof line,
+                "%s{\"name\":\"%s\",\"wall_ms\":%.3f,\"cpu_ms\":%.3f,\"bytes\":%llu,"
+                "\"mb_per_s\":%.2f,\"nodes_per_s\":%.0f}",
+                i ? "," : "", p.name.c_str(), p.wallSeconds * 1e3, p.cpuSeconds * 1e3,
+                static_cast<unsigned long long>(p.bytes),
+                perSecond(p.bytes, p.wallSeconds) / 1e6, perSecond(p.nodes, p.wallSeconds));
+            os << line;
+        }
+        std::snprintf(line, sizeof line, "],\"wall_ms\":%.3f,\"cpu_ms\":%.3f,\"nodes\":{\"total\":%llu",
+                      wallSeconds * 1e3, cpuSeconds * 1e3,
+                      static_cast<unsigned long long>(stats.totalNodes()));
+        os << line;
+        for (int t = 0; t < 6; ++t) os << ",\"" << TYPE_NAMES[t] << "\":" << stats.nodesByType[t];
+        os << "},\"max_depth\":" << stats.maxDepth
+           << ",\"allocations\":" << allocations
+           << ",\"peak_rss_kb\":" << peakRssKb() << "}\n";
+        return;
+    }
+
+    os << "--- jsonify stats (" << stats.files << (stats.files == 1 ? " file" : " files") << ") ---\n";
+    std::snprintf(line, sizeof line, "%-12s %10s %10s %12s %10s %12s\n",
+                  "phase", "wall ms", "cpu ms", "bytes", "MB/s", "nodes/s");
+    os << line;
+    for (const auto& p : stats.phases) {
+        std::snprintf(line, sizeof line, "%-12s %10.3f %10.3f %12llu %10.2f %12.0f\n",
+                      p.name.c_str(), p.wallSeconds * 1e3, p.cpuSeconds * 1e3,
+                      static_cast<unsigned long long>(p.bytes),
+                      perSecond(p.bytes, p.wallSeconds) / 1e6, perSecond(p.nodes, p.wallSeconds));
+        os << line;
+    }
+    std::snprintf(line, sizeof line, "%-12s %10.3f %10.3f\n", "total", wallSeconds * 1e3, cpuSeconds * 1e3);
+    os << line;
+
+    os << "nodes: " << stats.totalNodes() << " (";
+    for (int t = 0; t < 6; ++t) os << (t ? ", " : "") << TYPE_NAMES[t] << ' ' << stats.nodesByType[t];
+    os << "), max depth " << stats.maxDepth << '\n';
+    os << "allocations: " << allocations << ", peak RSS: " << peakRssKb() << " KB\n";
+}
@@ -0,0 +1,65 @@
+#ifndef JSONSTATS_H
+#define JSONSTATS_H
+
+#include <chrono>
+#include <cstdint>
+#include <memory>
+#include <ostream>
+#include <string>
+#include <vector>
+#include "jsonparser.h"
+
+// Run statistics for --stats: time per phase, throughput, shape of the
+// parsed documents and memory use.
+struct JsonStats {
+    struct Phase {
+        std::string name;
+        double   wallSeconds = 0;
+        double   cpuSeconds  = 0;    // CPU of the thread running the phase
+        uint64_t bytes = 0;
+        uint64_t nodes = 0;
+    };
+
+    std::vector<Phase> phases;       // in first-seen order
+    uint64_t nodesByType[6] = {};    // indexed by JsonValue::Type
+    size_t   maxDepth = 0;
+    size_t   files = 0;
+
+    Phase& phase(const std::string& name);
+    uint64_t addDocument(const std::shared_ptr<JsonValue>& root);   // returns its node count
+    void   merge(const JsonStats& other);
+    uint64_t totalNodes() const;
+};
+
+// Times a scope and adds it to the named phase when it ends.
+class PhaseTimer {
+public:
+    PhaseTimer(JsonStats* stats, const char* name, uint64_t bytes = 0);
+    ~PhaseTimer();
+    PhaseTimer(const PhaseTimer&) = delete;
+    PhaseTimer& operator=(const PhaseTimer&) = delete;
+
+    void setBytes(uint64_t bytes) { bytes_ = bytes; }
+    void setNodes(uint64_t nodes) { nodes_ = nodes; }
+
+private:
+    JsonStats*  stats_;
+    const char* name_;
+    uint64_t    bytes_;
+    uint64_t    nodes_ = 0;
+    std::chrono::steady_clock::time_point wall0_;
+    double      cpu0_ = 0;
+};
+
+double processCpuSeconds();
+// CPU time of the calling thread only, so that phases timed on concurrent
+// workers (-j) do not count each other's work. Work a phase hands to the
+// pool is not included.
+double threadCpuSeconds();
+long   peakRssKb();                  // -1 if unavailable
+
+// Writes the report; `json` selects a single-line JSON object.
+void printStats(const JsonStats& stats, std::ostream& os, bool json,
+                double wallSeconds, double cpuSeconds, uint64_t allocations);
+
+#endif
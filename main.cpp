@@ -1,41 +1,641 @@
 #include <iostream>
 #include <fstream>
 #include <sstream>
+#include <algorithm>
+#include <chrono>
+#include <condition_variable>
+#include <cstddef>
+#include <cstdlib>
 #include <cstring>
+#include <filesystem>
+#include <iterator>
+#include <memory_resource>
+#include <mutex>
 #include "jsonparser.h"
 #include "jsonformatter.h"
 #include "jsonlinter.h"
+#include "jsonbinary.h"
+#include "jsoncache.h"
+#include "threadpool.h"
+#include "jsonparallel.h"
+#include "jsonstats.h"
+#include "jsondiff.h"
+#include "jsonschema.h"
+#include "jsonpointer.h"
+#include "jsonindex.h"
+#include "jsonserver.h"
+#include "jsoncompress.h"
+#include "jsonpatch.h"
+#include "jsonalloc.h"
+#include <csignal>
 
 const std::string APP_VERSION = "0.0.1";
 
 void printUsage() {
     std::cout <<
-        "Usage: jsonify [options] <file.json>\n"
+        "Usage: jsonify [options] <file.json|dir>...\n"
         "Options:\n"
         "  --lint          Lint the JSON file\n"
         "  --format        Pretty-print the JSON file\n"
         "  --fix, -f       Attempt to auto-correct the JSON\n"
         "  --quiet, -q.    Suppress success messages\n"
         "  --compact       Compact output (no newlines/indent)\n"
+        "  --preserve      Keep numbers and strings exactly as written in the input\n"
         "  --indent N      Indent width (default 2)\n"
         "  --jsonc         Allow comments (JSONC)\n"
+        "  --emit-binary F Write the parsed document to F in binary form\n"
+        "  --input-binary  Input file is a binary document (see --emit-binary)\n"
+        "  --cache-dir D   Reuse lint results and parsed snapshots of unchanged files\n"
+        "  -j, --jobs N    Process files on N threads (default: all cores)\n"
+        "  --stats[=json]  Report phase timings, throughput and memory on stderr\n"
+        "  --diff A B      Report the paths where A and B differ (exit 1 if they do)\n"
+        "  --schema S      Validate against the JSON Schema in file S\n"
+        "  --ndjson        Input is newline-delimited JSON, one record per line\n"
+        "  --query P       Print the value at JSON Pointer P (e.g. /users/0/name)\n"
+        "  --build-index   Write a sidecar offset index (file.json.jidx) for --query\n"
+        "  --patch F       Apply the JSON Patch or Merge Patch in F and print the result\n"
+        "  --serve SOCK    Serve lint/format/query requests on Unix socket SOCK\n"
         "  --color         Enable color output (default)\n"
         "  --no-color      Disable color output\n"
         "  -v, --version   Show version information\n"
         "  --help          Show this help\n";
 }
 
+struct Options {
+    bool doLint = false, doFormat = false, compact = false, jsonc = false, doFix = false, doQuiet = false;
+    bool useColor = true;
+    bool inputBinary = false;
+    bool ndjson = false;
+    bool hasQuery = false;
+    std::string query;                 // JSON Pointer; "" is the whole document
+    bool buildIndex = false;
+    bool preserve = false;             // copy scalars from the input verbatim
+    std::string patchText;             // --patch source; the patch's scalars point into it
+    std::shared_ptr<JsonValue> patch;  // --patch document: merge patch unless an array
+    JsonPatch patchOps;                // its operations, when it is an RFC 6902 patch
+    int indent = 2;
+    std::string binaryOut;
+    const JsonCache* cache = nullptr;
+    ThreadPool* pool = nullptr;        // documents of 2 * PARALLEL_PARSE_CHUNK or more are parsed and printed in parallel
+    const JsonSchema* schema = nullptr;
+};
+
+static void printLintIssues(const std::vector<JsonLintIssue>& issues, const std::string& prefix,
+                            std::ostream& out) {
+    for (const auto& iss : issues) {
+        std::string sev;
+        switch (iss.severity) {
+            case JsonLintIssue::Severity::Error:    sev = "Error";    break;
+            case JsonLintIssue::Severity::Warning: sev = "Warning"; break;
+            case JsonLintIssue::Severity::Info:    sev = "Info";     break;
+        }
+        out << prefix << sev << ": " << iss.message;
+        if (iss.line != -1)
+            out << " (line " << iss.line << ", col " << iss.column << ")";
+        out << '\n';
+    }
+}
+
+static void printSchemaErrors(const std::vector<JsonSchemaError>& errors, const std::string& prefix,
+                              std::ostream& out) {
+    for (const auto& e : errors)
+        out << prefix << "Schema error: " << (e.path.empty() ? "(root)" : e.path) << ": " << e.message << '\n';
+}
+
+// Below this a single document is not worth splitting across threads.
+const size_t PARALLEL_PARSE_CHUNK = size_t(1) << 20;
+
+// opt.pool for a document of `bytes`, or null when it is too small to be
+// split; small documents then get the sequential parser.
+static ThreadPool* poolFor(const Options& opt, uintmax_t bytes) {
+    return bytes >= 2 * PARALLEL_PARSE_CHUNK ? opt.pool : nullptr;
+}
+
+template <class Parser>
+static std::shared_ptr<JsonValue> parseWith(const std::string& text, ThreadPool* pool,
+                                            std::pmr::memory_resource* mr) {
+    return pool ? parseParallel<Parser>(text, *pool, PARALLEL_PARSE_CHUNK, mr) : Parser::parse(text, mr);
+}
+
+// Parse with the dialect of `opt`; with --preserve the tree points into
+// `text`, which must outlive it. With a pool, big documents are split.
+static std::shared_ptr<JsonValue> parseText(const std::string& text, const Options& opt,
+                                            ThreadPool* pool, std::pmr::memory_resource* mr) {
+    if (opt.preserve) return opt.jsonc ? parseWith<JsoncLexemeParser>(text, pool, mr)
+                                       : parseWith<JsonLexemeParser>(text, pool, mr);
+    return opt.jsonc ? parseWith<JsoncParser>(text, pool, mr) : parseWith<JsonParser>(text, pool, mr);
+}
+
+// --ndjson: every non-blank line is a separate document. A bad record is
+// reported with its line number and does not stop the file; the file fails
+// if any record did. With only --schema (and no --jsonc), records are
+// validated as they are read, without building a DOM. The file is read (and decompressed) on a
+// reader thread and records are handled as its chunks arrive, so memory
+// stays bounded whatever the file's size.
+static void processNdjson(const std::string& filename, const Options& opt, std::ostream& out,
+                          JsonStats* stats) {
+    if (stats) ++stats->files;
+    JsonCompressedReader reader(filename);
+
+    const bool needDom = opt.doLint || opt.doFormat || opt.doFix || opt.jsonc || !opt.schema;
+    std::pmr::monotonic_buffer_resource arena;     // reused by every record
+    size_t records = 0, invalid = 0, lineNo = 0;
+    uint64_t nodes = 0, bytes = 0;
+    PhaseTimer t(stats, "records");
+    auto handleLine = [&](std::string_view line) {
+        ++lineNo;
+        if (line.find_first_not_of(" \t\r") == std::string_view::npos) return;
+        ++records;
+
+        auto prefix = [&] { return "line " + std::to_string(lineNo) + ": "; };
+        std::vector<JsonSchemaError> errors;
+        try {
+            if (!needDom) {
+                errors = opt.schema->validate(line);
+            } else {
+                std::string text(line);
+                if (opt.doFix) text = correctJson(text, opt.jsonc);
+                auto root = parseText(text, opt, nullptr, &arena);
+                if (stats) nodes += stats->addDocument(root);
+                if (opt.doLint) printLintIssues(lintJson(root, text), prefix(), out);
+                if (opt.schema) errors = opt.schema->validate(root);
+                if (opt.doFormat) {
+                    printJson(root, out, 0, opt.indent, true, opt.useColor);
+                    out << '\n';
+                }
+            }
+        } catch (const std::exception& e) {
+            out << prefix() << "Error: " << e.what() << '\n';
+            ++invalid;
+        }
+        arena.release();
+        if (!errors.empty()) {
+            printSchemaErrors(errors, prefix(), out);
+            ++invalid;
+        }
+    };
+    // Splits `chunk` into lines; a trailing partial line is kept in `carry`
+    // until the chunk that completes it arrives.
+    std::string carry;
+    auto feed = [&](std::string_view chunk) {
+        bytes += chunk.size();
+        size_t pos = 0;
+        for (size_t nl; (nl = chunk.find('\n', pos)) != std::string_view::npos; pos = nl + 1) {
+            std::string_view line = chunk.substr(pos, nl - pos);
+            if (!carry.empty()) {
+                carry.append(line);
+                handleLine(carry);
+                carry.clear();
+            } else {
+                handleLine(line);
+            }
+        }
+        carry.append(chunk.substr(pos));
+    };
+
+    for (std::string_view chunk = reader.next(); !chunk.empty(); chunk = reader.next()) feed(chunk);
+    if (!carry.empty()) handleLine(carry);
+    t.setBytes(bytes);
+    t.setNodes(nodes);
+
+    if (!opt.doQuiet && !opt.doFormat) out << records << " records, " << invalid << " invalid.\n";
+    if (invalid) throw std::runtime_error(std::to_string(invalid) + " invalid record(s)");
+}
+
+// --query through a sidecar index: maps the file and parses only the value
+// the pointer leads to. Returns false when there is no index or it does not
+// apply, and the file is then parsed as usual.
+static bool queryWithIndex(const std::string& filename, const Options& opt, std::ostream& out,
+                           JsonStats* stats) {
+    if (opt.inputBinary || opt.jsonc || opt.doFix || opt.doLint || opt.schema || !opt.binaryOut.empty())
+        return false;
+    const std::string indexFile = jsonIndexPath(filename);
+    std::error_code ec;
+    if (!std::filesystem::is_regular_file(indexFile, ec)) return false;
+
+    std::string slice;                    // --preserve: the value's source text
+    std::shared_ptr<JsonValue> value;
+    {
+        PhaseTimer t(stats, "query");
+        JsonIndex index(filename, indexFile);
+        if (!index.fresh()) {
+            if (!opt.doQuiet)
+                std::cerr << "Warning: " << indexFile << " is out of date, ignoring it (rerun --build-index)\n";
+            return false;
+        }
+        value = index.query(opt.query, std::pmr::get_default_resource(), opt.preserve ? &slice : nullptr);
+    }
+    PhaseTimer t(stats, "format");
+    printJson(value, out, 0, opt.indent, opt.compact, opt.useColor);
+    out << '\n';
+    return true;
+}
+
+// --patch: a patch that only touches independent paths is applied while
+// copying the source, which is mapped rather than read when it is a plain
+// file; anything else goes through the DOM, patched in place, and is printed
+// like --format (also when --format or DOM-only options are given).
+static void patchFile(const std::string& filename, const Options& opt, std::ostream& out, JsonStats* stats) {
+    const bool merge = opt.patch->getType() != JsonValue::Type::Array;
+    const bool stream = !opt.jsonc && !opt.doFix && !opt.doFormat
+                        && (merge || canStreamJsonPatch(opt.patchOps));
+    std::error_code ec;
+    if (stream && std::filesystem::is_regular_file(filename, ec)
+        && detectCompression(filename) == JsonCompression::None) {
+        JsonMappedFile source(filename);
+        PhaseTimer t(stats, "patch", source.size());
+        std::string_view text(source.data(), source.size());
+        if (merge) streamJsonMergePatch(text, opt.patch, out);
+        else       streamJsonPatch(text, opt.patchOps, out);
+        return;
+    }
+
+    std::string src;
+    {
+        PhaseTimer t(stats, "read");
+        src = readJsonInput(filename);
+        t.setBytes(src.size());
+    }
+    if (stream) {
+        PhaseTimer t(stats, "patch", src.size());
+        if (merge) streamJsonMergePatch(src, opt.patch, out);
+        else       streamJsonPatch(src, opt.patchOps, out);
+        return;
+    }
+    if (opt.doFix) {
+        PhaseTimer t(stats, "fix", src.size());
+        src = correctJson(src, opt.jsonc);
+    }
+    ThreadPool* pool = poolFor(opt, src.size());
+    std::pmr::monotonic_buffer_resource arena;
+    std::shared_ptr<JsonValue> parsed;   // kept: a parallel parse's nodes live as long as its root
+    {
+        PhaseTimer t(stats, "parse", src.size());
+        parsed = parseText(src, opt, pool, &arena);
+    }
+    std::shared_ptr<JsonValue> root = parsed;
+    {
+        PhaseTimer t(stats, "patch");
+        if (merge) applyJsonMergePatch(root, opt.patch, &arena);
+        else       applyJsonPatch(root, opt.patchOps, &arena);
+    }
+    PhaseTimer t(stats, "format");
+    if (pool) printJsonParallel(root, out, *pool, 0, opt.indent, opt.compact, opt.useColor);
+    else      printJson(root, out, 0, opt.indent, opt.compact, opt.useColor);
+    out << '\n';
+}
+
+// Lint/format one file. Output is written to `out` so that files processed
+// in parallel can still be printed in command-line order. `stats` may be null.
+static void processFile(const std::string& filename, const Options& opt, std::ostream& out,
+                        JsonStats* stats) {
+    if (opt.ndjson) return processNdjson(filename, opt, out, stats);
+    if (stats) ++stats->files;
+    if (opt.buildIndex) {
+        PhaseTimer t(stats, "index");
+        if (detectCompression(filename) != JsonCompression::None)
+            throw std::runtime_error("Cannot index compressed input; decompress " + filename + " first");
+        JsonIndexSummary summary = buildJsonIndex(filename, jsonIndexPath(filename));
+        if (!opt.doQuiet)
+            out << "Indexed " << summary.containers << " containers, " << summary.entries << " entries.\n";
+        return;
+    }
+    if (opt.hasQuery && queryWithIndex(filename, opt, out, stats)) return;
+    if (opt.patch) return patchFile(filename, opt, out, stats);
+    std::string src;
+    // The parsed DOM lives in this arena and is released in one
+    // go when the file is done; declared before `root` so it outlives it.
+    std::pmr::monotonic_buffer_resource arena;
+    std::shared_ptr<JsonValue> root;
+    std::vector<JsonLintIssue> issues;
+    bool haveIssues = false;
+    uint64_t docNodes = 0;            // for --stats throughput
+    ThreadPool* pool = nullptr;       // set for documents big enough to split
+
+    if (opt.inputBinary) {
+        // ---- Load pre-parsed binary document ----
+        PhaseTimer t(stats, "load-binary");
+        std::error_code ec;
+        pool = poolFor(opt, std::filesystem::file_size(filename, ec));
+        JsonBinaryFile bin(filename);
+        root = bin.view().root().toValue(&arena);
+        if (stats) docNodes = stats->addDocument(root);
+    } else {
+        // ---- Cache lookup ----
+        // First by the file's size and mtime; if that does not answer the
+        // run, the text is read and the entry verified against its content.
+        const JsonCache* cache = opt.cache;
+        JsonCacheEntry cached;
+        const uint64_t optionsKey = (opt.jsonc ? 1u : 0u) | (opt.doFix ? 2u : 0u);
+        bool hit = false;
+        std::string original;             // cache key text when --fix rewrites src
+        if (cache) {
+            PhaseTimer t(stats, "cache");
+            hit = cache->lookup(filename, optionsKey, cached);
+        }
+        // Snapshots carry no source text, so --preserve always parses; and
+        // their object keys are sorted, so a tree rebuilt from one would not
+        // iterate members in the order a fresh parse does. Anything printed
+        // is therefore parsed, or a warm run would format differently.
+        const bool printsTree = opt.doFormat || opt.hasQuery;
+        // Only --schema and --emit-binary can work from a snapshot.
+        const bool wantsSnapshot = opt.schema || !opt.binaryOut.empty();
+        const bool answered = hit && !printsTree && !opt.preserve && (!opt.doLint || cached.hasLint)
+                              && (!wantsSnapshot || !cached.snapshot.empty());
+        if (!answered) {
+            {
+                PhaseTimer t(stats, "read");
+                src = readJsonInput(filename);
+                t.setBytes(src.size());
+            }
+            pool = poolFor(opt, src.size());
+            if (cache && !hit) {
+                PhaseTimer t(stats, "cache", src.size());
+                hit = cache->lookup(filename, src, optionsKey, cached);
+            }
+        }
+        if (opt.doLint && hit && cached.hasLint) {
+            issues = cached.issues;
+            haveIssues = true;
+        }
+
+        // A schema alone is checked while reading the text; it needs the DOM
+        // when the text is rewritten by --fix first, has JSONC comments,
+        // which the streaming reader does not skip, or was not read at all.
+        const bool streamSchema = opt.schema && !opt.doFix && !opt.jsonc && !answered;
+        bool needRoot = opt.doFormat || opt.hasQuery || !opt.binaryOut.empty() || (opt.doLint && !haveIssues)
+                        || (!hit && (cache || !streamSchema)) || (opt.schema && !streamSchema);
+        if (needRoot && hit && !cached.snapshot.empty() && !opt.preserve && !printsTree) {
+            PhaseTimer t(stats, "cache", cached.snapshot.size());
+            JsonBinaryView view(cached.snapshot.data(), cached.snapshot.size());
+            root = view.root().toValue(&arena);
+        } else if (needRoot) {
+            if (opt.doFix) {
+                PhaseTimer t(stats, "fix", src.size());
+                if (cache) original = src;
+                src = correctJson(src, opt.jsonc);
+            }
+
+            // ---- Parse ----
+            // JSONC comments are skipped by the parser itself
+            {
+                PhaseTimer t(stats, "parse", src.size());
+                root = parseText(src, opt, pool, &arena);
+            }
+            if (stats) {
+                docNodes = stats->addDocument(root);
+                stats->phase("parse").nodes += docNodes;
+            }
+        }
+        if (stats && root && !docNodes) docNodes = stats->addDocument(root);
+
+        if (opt.doLint && !haveIssues) {
+            PhaseTimer t(stats, "lint", src.size());
+            t.setNodes(docNodes);
+            issues = lintJson(root, src);
+            haveIssues = true;
+        }
+
+        // A snapshot is stored only for runs that can use it later.
+        const bool addSnapshot = wantsSnapshot && root && cached.snapshot.empty();
+        if (cache && (!hit || (haveIssues && !cached.hasLint) || addSnapshot)) {
+            PhaseTimer t(stats, "cache");
+            if (haveIssues) {
+                cached.hasLint = true;
+                cached.issues = issues;
+            }
+            if (addSnapshot) cached.snapshot = toJsonBinary(root);
+            cache->store(filename, original.empty() ? src : original, optionsKey, cached);
+        }
+    }
+
+    if (!opt.binaryOut.empty()) {
+        PhaseTimer t(stats, "emit-binary");
+        std::ofstream bin(opt.binaryOut, std::ios::binary);
+        if (!bin) throw std::runtime_error("Cannot write " + opt.binaryOut);
+        writeJsonBinary(root, bin);
+    }
+
+    // ---- Lint ----
+    if (opt.doLint) {
+        if (!haveIssues) {
+            PhaseTimer t(stats, "lint", src.size());
+            t.setNodes(docNodes);
+            issues = lintJson(root, src);
+        }
+        if (issues.empty()) {
+           if (!opt.doQuiet) out << "No lint issues.\n";
+        } else {
+            printLintIssues(issues, "", out);
+        }
+    }
+
+    // ---- Query ----
+    std::shared_ptr<JsonValue> shown = root;
+    if (opt.hasQuery) {
+        PhaseTimer t(stats, "query");
+        shown = resolveJsonPointer(root, opt.query);
+    }
+
+    // ---- Format ----
+    if (opt.doFormat || opt.hasQuery) {
+        PhaseTimer t(stats, "format");
+        if (shown == root) t.setNodes(docNodes);
+        if (pool) printJsonParallel(shown, out, *pool, 0, opt.indent, opt.compact, opt.useColor);
+        else      printJson(shown, out, 0, opt.indent, opt.compact, opt.useColor);
+        out << '\n';
+    }
+
+    // ---- Schema ----
+    if (opt.schema) {
+        std::vector<JsonSchemaError> errors;
+        {
+            PhaseTimer t(stats, "validate", root ? 0 : src.size());
+            t.setNodes(docNodes);
+            errors = root ? opt.schema->validate(root) : opt.schema->validate(src);
+        }
+        printSchemaErrors(errors, "", out);
+        if (!errors.empty()) throw std::runtime_error(std::to_string(errors.size()) + " schema error(s)");
+        if (!opt.doQuiet) out << "Valid.\n";
+    }
+
+    if (!opt.doLint && !opt.doFormat && !opt.hasQuery && !opt.schema && opt.doQuiet) out << "Parsed successfully.\n";
+}
+
+// Expand directories (recursively, sorted) into the JSON files they contain.
+static std::vector<std::string> expandInputs(const std::vector<std::string>& args, const Options& opt) {
+    namespace fs = std::filesystem;
+    std::vector<std::string> files;
+    for (const auto& arg : args) {
+        std::error_code ec;
+        if (!fs::is_directory(arg, ec)) { files.push_back(arg); continue; }
+        std::vector<std::string> found;
+        for (fs::recursive_directory_iterator it(arg, ec), end; !ec && it != end; it.increment(ec)) {
+            if (!it->is_regular_file(ec)) continue;
+            auto ext = it->path().extension();
+            if (ext == ".gz" || ext == ".zst") ext = it->path().stem().extension();   // doc.json.gz
+            if (ext == ".json" || (opt.jsonc && ext == ".jsonc")
+                || (opt.ndjson && (ext == ".ndjson" || ext == ".jsonl")))
+                found.push_back(it->path().string());
+        }
+        std::sort(found.begin(), found.end());
+        files.insert(files.end(), found.begin(), found.end());
+    }
+    return files;
+}
+
+// One side of --diff: the document, its subtree hashes and the arena the
+// DOM lives in (declared first so it outlives the tree).
+struct DiffSide {
+    std::pmr::monotonic_buffer_resource arena;
+    std::shared_ptr<JsonValue> root;
+    JsonSubtreeHashes hashes;
+    JsonStats stats;
+    std::string error;
+};
+
+static void loadDiffSide(const std::string& filename, const Options& opt, DiffSide& side, bool doStats) {
+    JsonStats* stats = doStats ? &side.stats : nullptr;
+    if (stats) ++stats->files;
+    if (opt.inputBinary) {
+        PhaseTimer t(stats, "load-binary");
+        JsonBinaryFile bin(filename);
+        side.root = bin.view().root().toValue(&side.arena);
+    } else {
+        std::string src;
+        {
+            PhaseTimer t(stats, "read");
+            src = readJsonInput(filename);
+            t.setBytes(src.size());
+        }
+        if (opt.doFix) {
+            PhaseTimer t(stats, "fix", src.size());
+            src = correctJson(src, opt.jsonc);
+        }
+        PhaseTimer t(stats, "parse", src.size());
+        if (ThreadPool* pool = poolFor(opt, src.size())) {
+            side.root = opt.jsonc ? parseParallel<JsoncParser>(src, *pool, PARALLEL_PARSE_CHUNK, &side.arena)
+                                  : parseParallel<JsonParser>(src, *pool, PARALLEL_PARSE_CHUNK, &side.arena);
+        } else {
+            side.root = opt.jsonc ? JsoncParser::parse(src, &side.arena)
+                                  : JsonParser::parse(src, &side.arena);
+        }
+    }
+    uint64_t nodes = stats ? stats->addDocument(side.root) : 0;
+    PhaseTimer t(stats, "hash");
+    t.setNodes(nodes);
+    hashJson(side.root, &side.hashes);
+}
+
+// --diff: both documents are loaded and hashed concurrently, then compared
+// top-down, skipping every subtree whose hashes match. Exit status follows
+// diff(1): 0 identical, 1 different, 2 on error.
+static int runDiff(const std::string& fileA, const std::string& fileB, Options opt,
+                   size_t jobs, JsonStats* stats) {
+    std::unique_ptr<ThreadPool> pool;
+    if (jobs != 1) pool = std::make_unique<ThreadPool>(jobs);
+    opt.pool = pool.get();
+
+    DiffSide sides[2];
+    const std::string* names[2] = {&fileA, &fileB};
+    auto load = [&](int i) {
+        try {
+            loadDiffSide(*names[i], opt, sides[i], stats != nullptr);
+        } catch (const std::exception& e) {
+            sides[i].error = e.what();
+        }
+    };
+    if (pool) {
+        TaskGroup group(*pool);
+        group.run([&] { load(0); });
+        group.run([&] { load(1); });
+        group.wait();
+    } else {
+        load(0);
+        load(1);
+    }
+
+    int status = 0;
+    for (int i = 0; i < 2; ++i) {
+        if (stats) stats->merge(sides[i].stats);
+        if (!sides[i].error.empty()) {
+            std::cerr << "Error: " << *names[i] << ": " << sides[i].error << '\n';
+            status = 2;
+        }
+    }
+    if (status) return status;
+
+    std::vector<JsonDifference> diffs;
+    {
+        PhaseTimer t(stats, "diff");
+        diffs = diffJson(sides[0].root, sides[0].hashes, sides[1].root, sides[1].hashes);
+    }
+    if (opt.doQuiet) return diffs.empty() ? 0 : 1;
+
+    PhaseTimer t(stats, "emit-diff");
+    auto value = [&](const std::shared_ptr<JsonValue>& v) { printJson(v, std::cout, 0, 2, true, false); };
+    for (const auto& d : diffs) {
+        const std::string path = d.path.empty() ? "(root)" : d.path;
+        switch (d.kind) {
+        case JsonDifference::Kind::Removed:
+            std::cout << "- " << path << '\n';
+            break;
+        case JsonDifference::Kind::Added:
+            std::cout << "+ " << path << ": ";
+            value(d.after);
+            std::cout << '\n';
+            break;
+        case JsonDifference::Kind::Changed:
+            std::cout << "~ " << path << ": ";
+            value(d.before);
+            std::cout << " -> ";
+            value(d.after);
+            std::cout << '\n';
+            break;
+        }
+    }
+    if (diffs.empty()) std::cout << "No differences.\n";
+    return diffs.empty() ? 0 : 1;
+}
+
+// --serve: answer requests until SIGINT/SIGTERM or a "shutdown" request.
+static JsonServer* gServer = nullptr;
+
+static int runServer(const std::string& socketPath, const Options& opt, size_t jobs) {
+    JsonServerOptions so;
+    so.indent = opt.indent;
+    so.jsonc = opt.jsonc;
+    ThreadPool pool(jobs);
+    JsonServer server(pool, so);
+    gServer = &server;
+    auto onSignal = [](int) { if (gServer) gServer->stop(); };
+    std::signal(SIGINT, onSignal);
+    std::signal(SIGTERM, onSignal);
+    int status = 0;
+    try {
+        if (!opt.doQuiet) std::cerr << "Listening on " << socketPath << '\n';
+        server.serve(socketPath);
+    } catch (const std::exception& e) {
+        std::cerr << "Error: " << e.what() << '\n';
+        status = 1;
+    }
+    gServer = nullptr;
+    return status;
+}
+
 int main(int argc, char* argv[]) {
     if (argc < 2) { printUsage(); return 1; }
 
-    bool doLint = false, doFormat = false, compact = false, jsonc = false, doFix = false, doQuiet = false;
-    bool useColor = true;
+    Options opt;
 
     // What is the purpose of this variable? It is not used and causes compile error
     // bool colorSpecified = false;
     
-    int indent = 2;
-    std::string filename;
+    std::vector<std::string> inputs;
+    std::string cacheDir;
+    size_t jobs = 0;
+    bool doStats = false, statsJson = false;
+    std::string diffA, diffB, schemaFile, serveSocket, patchPath;
 
     for (int i = 1; i < argc; ++i) {
         std::string arg = argv[i];
@@ -44,96 +644,201 @@ int main(int argc, char* argv[]) {
             std::cout << "jsonify v" << APP_VERSION << " (Semantic Versioning)\n";
             return 0;
         }
-        if (arg == "--lint")      doLint   = true;
-        else if (arg == "--format") doFormat = true;
-        else if (arg == "--compact") compact = true;
-        else if (arg == "--jsonc")    jsonc    = true;
+        if (arg == "--lint")      opt.doLint   = true;
+        else if (arg == "--format") opt.doFormat = true;
+        else if (arg == "--compact") opt.compact = true;
+        else if (arg == "--jsonc")    opt.jsonc    = true;
         else if (arg == "--fix" || arg == "-f" ) {
-            doFix = true;
+            opt.doFix = true;
         }
         else if (arg == "--quiet" || arg == "-q") {
-            doQuiet = true;
+            opt.doQuiet = true;
         }
-        else if (arg == "--color") { useColor = true; /*colorSpecified = true;*/ }
-        else if (arg == "--no-color") { useColor = false; /*colorSpecified = true;*/ }
-        else if (arg == "--indent" && i+1 < argc) { indent = std::stoi(argv[++i]); }
+        else if (arg == "--color") { opt.useColor = true; /*colorSpecified = true;*/ }
+        else if (arg == "--no-color") { opt.useColor = false; /*colorSpecified = true;*/ }
+        else if (arg == "--indent" && i+1 < argc) { opt.indent = std::stoi(argv[++i]); }
+        else if (arg == "--emit-binary" && i+1 < argc) { opt.binaryOut = argv[++i]; }
+        else if (arg == "--input-binary") { opt.inputBinary = true; }
+        else if (arg == "--cache-dir" && i+1 < argc) { cacheDir = argv[++i]; }
+        else if ((arg == "--jobs" || arg == "-j") && i+1 < argc) {
+            // 0 = one per core; at most four digits so a typo cannot spawn millions
+            std::string n = argv[++i];
+            if (n.empty() || n.size() > 4 || n.find_first_not_of("0123456789") != std::string::npos) {
+                std::cerr << "Invalid job count: " << n << "\n\n";
+                printUsage();
+                return 1;
+            }
+            jobs = std::stoul(n);
+        }
+        else if (arg == "--stats") { doStats = true; }
+        else if (arg == "--stats=json") { doStats = true; statsJson = true; }
+        else if (arg == "--diff" && i+2 < argc) { diffA = argv[++i]; diffB = argv[++i]; }
+        else if (arg == "--schema" && i+1 < argc) { schemaFile = argv[++i]; }
+        else if (arg == "--ndjson") { opt.ndjson = true; }
+        else if (arg == "--query" && i+1 < argc) { opt.hasQuery = true; opt.query = argv[++i]; }
+        else if (arg == "--serve" && i+1 < argc) { serveSocket = argv[++i]; }
+        else if (arg == "--build-index") { opt.buildIndex = true; }
+        else if (arg == "--preserve") { opt.preserve = true; }
+        else if (arg == "--patch" && i+1 < argc) { patchPath = argv[++i]; }
         else if (arg == "--help") { printUsage(); return 0; }
-        else if (arg[0] != '-')    filename = arg;
+        else if (arg[0] != '-')    inputs.push_back(arg);
         else { std::cerr << "Unknown option: " << arg << '\n'; return 1; }
     }
 
-    if (filename.empty()) { std::cerr << "No input file.\n"; return 1; }
+    if (!serveSocket.empty()) return runServer(serveSocket, opt, jobs);
 
+    std::vector<std::string> files = expandInputs(inputs, opt);
+    if (!diffA.empty() && !files.empty()) {
+        std::cerr << "--diff takes exactly two files.\n";
+        return 2;
+    }
+    if (files.empty() && diffA.empty()) { std::cerr << "No input file.\n"; return 1; }
+    if (files.size() > 1 && !opt.binaryOut.empty()) {
+        std::cerr << "--emit-binary takes a single input file.\n";
+        return 1;
+    }
+    if (opt.ndjson && (opt.inputBinary || !opt.binaryOut.empty())) {
+        std::cerr << "--ndjson cannot be combined with binary input or output.\n";
+        return 1;
+    }
+    if (opt.buildIndex && (opt.jsonc || opt.ndjson || opt.inputBinary)) {
+        std::cerr << "--build-index takes plain JSON input.\n";
+        return 1;
+    }
+    if (opt.ndjson && opt.hasQuery) {
+        std::cerr << "--query cannot be combined with --ndjson.\n";
+        return 1;
+    }
+    if (!patchPath.empty()) {
+        if (opt.doLint || opt.hasQuery || opt.ndjson || opt.buildIndex || !schemaFile.empty()
+            || opt.inputBinary || !opt.binaryOut.empty() || !diffA.empty()) {
+            std::cerr << "--patch cannot be combined with --lint, --query, --schema, --ndjson, "
+                         "--build-index, --diff or binary input/output.\n";
+            return 1;
+        }
+        try {
+            // with lexemes, inserted numbers and strings are copied as written
+            opt.patchText = readJsonInput(patchPath);
+            opt.patch = JsonLexemeParser::parse(opt.patchText);
+            if (opt.patch->getType() == JsonValue::Type::Array) opt.patchOps = parseJsonPatch(opt.patch);
+        } catch (const std::exception& e) {
+            std::cerr << "Error: " << patchPath << ": " << e.what() << '\n';
+            return 1;
+        }
+    }
+
+    std::unique_ptr<JsonCache> cache;
     try {
-        std::ifstream f(filename);
-        if (!f) throw std::runtime_error("Cannot open " + filename);
-        std::stringstream buf; buf << f.rdbuf();
-        std::string src = buf.str();
-
-        // ---- JSONC comment stripping ----
-        if (jsonc) {
-            std::string clean;
-            bool inStr = false, esc = false;
-            for (size_t i = 0; i < src.size(); ++i) {
-                char c = src[i];
-                if (esc) { clean += c; esc = false; continue; }
-                if (c == '\\') { esc = true; clean += c; continue; }
-                if (c == '"' && !esc) inStr = !inStr;
-                if (!inStr && i+1 < src.size()) {
-                    if (src[i] == '/' && src[i+1] == '/') { // // comment
-                        i = src.find('\n', i) ; if (i == std::string::npos) i = src.size()-1;
-                        continue;
-                    }
-                    if (src[i] == '/' && src[i+1] == '*') { // /* */
-                        size_t end = src.find("*/", i+2);
-                        i = (end == std::string::npos) ? src.size()-1 : end+1;
-                        continue;
-                    }
-                }
-                clean += c;
-            }
-            src = clean;
+        if (!cacheDir.empty()) cache = std::make_unique<JsonCache>(cacheDir);
+    } catch (const std::exception& e) {
+        std::cerr << "Error: " << e.what() << '\n';
+        return 1;
+    }
+    opt.cache = cache.get();
+
+    std::unique_ptr<JsonSchema> schema;
+    if (!schemaFile.empty()) {
+        try {
+            schema = std::make_unique<JsonSchema>(JsonSchema::loadFromFile(schemaFile));
+        } catch (const std::exception& e) {
+            std::cerr << "Error: " << schemaFile << ": " << e.what() << '\n';
+            return 1;
         }
+    }
+    opt.schema = schema.get();
 
-        if (doFix) {
-            src = correctJson(src);
+    // ---- Stats ----
+    JsonStats stats;
+    std::mutex statsMutex;
+    const auto wall0 = std::chrono::steady_clock::now();
+    const double cpu0 = processCpuSeconds();
+    setAllocationCounting(doStats);
+    auto reportStats = [&](int status) {
+        if (doStats) {
+            double wall = std::chrono::duration<double>(std::chrono::steady_clock::now() - wall0).count();
+            printStats(stats, std::cerr, statsJson, wall, processCpuSeconds() - cpu0, allocationCount());
         }
+        return status;
+    };
 
-        // ---- Parse ----
-        auto root = JsonParser::parse(src);
+    if (!diffA.empty()) return reportStats(runDiff(diffA, diffB, opt, jobs, doStats ? &stats : nullptr));
 
-        // ---- Lint ----
-        if (doLint) {
-            auto issues = lintJson(root, src);
-            if (issues.empty()) {
-               if (!doQuiet) std::cout << "No lint issues.\n";
-            } else {
-                for (const auto& iss : issues) {
-                    std::string sev;
-                    switch (iss.severity) {
-                        case JsonLintIssue::Severity::Error:    sev = "Error";    break;
-                        case JsonLintIssue::Severity::Warning: sev = "Warning"; break;
-                        case JsonLintIssue::Severity::Info:    sev = "Info";     break;
-                    }
-                    std::cout << sev << ": " << iss.message;
-                    if (iss.line != -1)
-                        std::cout << " (line " << iss.line << ", col " << iss.column << ")";
-                    std::cout << '\n';
-                }
-            }
+    // Single file: no buffering; a pool only if the document is big enough
+    // to be split.
+    if (files.size() == 1) {
+        std::unique_ptr<ThreadPool> pool;
+        std::error_code ec;
+        if (jobs != 1
+            && std::filesystem::file_size(files[0], ec) >= 2 * PARALLEL_PARSE_CHUNK && !ec) {
+            pool = std::make_unique<ThreadPool>(jobs);
+            opt.pool = pool.get();
         }
-
-        // ---- Format ----
-        if (doFormat) {
-            printJson(root, std::cout, 0, indent, compact, useColor);
-            std::cout << '\n';
+        try {
+            processFile(files[0], opt, std::cout, doStats ? &stats : nullptr);
+        } catch (const std::exception& e) {
+            std::cerr << "Error: " << e.what() << '\n';
+            return reportStats(1);
         }
+        return reportStats(0);
+    }
 
-        if (!doLint && !doFormat && doQuiet) std::cout << "Parsed successfully.\n";
+    // Many files: run on the pool, largest first so one big file does not
+    // end up alone at the tail, and print each file's result in input order.
+    struct Result {
+        std::ostringstream out;
+        std::string error;
+        bool done = false;
+    };
+    std::vector<Result> results(files.size());
+    std::vector<std::pair<uintmax_t, size_t>> order;
+    order.reserve(files.size());
+    for (size_t i = 0; i < files.size(); ++i) {
+        std::error_code ec;
+        uintmax_t size = std::filesystem::file_size(files[i], ec);
+        order.emplace_back(ec ? 0 : size, i);
+    }
+    std::stable_sort(order.begin(), order.end(),
+                     [](const auto& a, const auto& b) { return a.first > b.first; });
 
-    } catch (const std::exception& e) {
-        std::cerr << "Error: " << e.what() << '\n';
-        return 1;
+    std::mutex doneMutex;
+    std::condition_variable doneCv;
+    ThreadPool pool(jobs);
+    opt.pool = &pool;
+    TaskGroup group(pool);
+    for (const auto& entry : order) {
+        size_t idx = entry.second;
+        group.run([&, idx] {
+            Result& r = results[idx];
+            JsonStats fileStats;
+            try {
+                processFile(files[idx], opt, r.out, doStats ? &fileStats : nullptr);
+            } catch (const std::exception& e) {
+                r.error = e.what();
+            }
+            if (doStats) {
+                std::lock_guard<std::mutex> lock(statsMutex);
+                stats.merge(fileStats);
+            }
+            std::lock_guard<std::mutex> lock(doneMutex);
+            r.done = true;
+            doneCv.notify_all();
+        });
+    }
+
+    int status = 0;
+    for (size_t i = 0; i < files.size(); ++i) {
+        Result& r = results[i];
+        {
+            std::unique_lock<std::mutex> lock(doneMutex);
+            doneCv.wait(lock, [&] { return r.done; });
+        }
+        std::cout << "==> " << files[i] << " <==\n" << r.out.str();
+        std::cout.flush();
+        if (!r.error.empty()) {
+            std::cerr << "Error: " << files[i] << ": " << r.error << '\n';
+            status = 1;
+        }
     }
-    return 0;
+    group.wait();
+    return reportStats(status);
 }
@@ -0,0 +1,119 @@
+// parallel_test.cpp
+#include "jsonparser.h"
+#include "jsonformatter.h"
+#include "jsonparallel.h"
+#include "threadpool.h"
+#include <iomanip>
+#include <iostream>
+#include <memory_resource>
+#include <sstream>
+#include <string>
+#include <vector>
+
+struct ParallelTest {
+    std::string input;
+    std::string description;
+};
+
+std::string render(const std::shared_ptr<JsonValue>& v) {
+    std::ostringstream os;
+    printJson(v, os, 0, 2, true, false);
+    return os.str();
+}
+
+// Parsed in parallel with tiny chunks, the result (or the error) must be
+// byte-for-byte what the sequential parser produces.
+template <class Parser>
+void run_parallel_test(ThreadPool& pool, const ParallelTest& t) {
+    std::cout << std::left << std::setw(38) << ("[" + t.description + "]")
+              << " → ";
+    std::string expected, actual;
+    try { expected = render(Parser::parse(t.input)); }
+    catch (const std::exception& e) { expected = std::string("error: ") + e.what(); }
+    try { actual = render(parseParallel<Parser>(t.input, pool, 4)); }
+    catch (const std::exception& e) { actual = std::string("error: ") + e.what(); }
+
+    if (expected == actual) std::cout << "PASS\n";
+    else std::cout << "FAIL\n  sequential: " << expected << "\n  parallel:   " << actual << '\n';
+}
+
+int main() {
+    std::cout << "=== Parallel Parse Tests ===\n\n";
+
+    ThreadPool pool(4);
+
+    std::string records = "[";
+    for (int i = 0; i < 200; ++i) {
+        if (i) records += ",\n";
+        records += R"({"id":)" + std::to_string(i) + R"(,"s":"a,b]\"}","n":[1,{"x":null}]})";
+    }
+    records += "]";
+
+    std::string members = "{";
+    for (int i = 0; i < 200; ++i) {
+        if (i) members += ",";
+        members += "\"k" + std::to_string(i % 150) + "\":" + std::to_string(i);
+    }
+    members += "}";
+
+    std::vector<ParallelTest> tests = {
+        {records,                                  "array of records"},
+        {members,                                  "object with repeated keys"},
+        {"[1,2,3,4,5,6,7,8,9,10,11,12,13,14]",     "small numbers"},
+        {"\"scalar root, not split\"",             "scalar root"},
+        {"[1,2,3,4,5,6,7,8,9,10,11,12,,13,14]",    "error in a later chunk"},
+        {"[1,2,3,4,5,6,7,8,9,10,11,12,13,14] x",   "trailing content"},
+        {"[\"1,2,3,4\",\"5,6,7,8,9,10,11,12",      "unterminated string"},
+    };
+    for (const auto& t : tests) run_parallel_test<JsonParser>(pool, t);
+
+    {
+        // Chunks draw their memory from the caller's resource, not the
+        // default one; the counter needs no lock, parseParallel serialises.
+        struct Counting : std::pmr::memory_resource {
+            size_t calls = 0;
+            void* do_allocate(size_t n, size_t a) override {
+                ++calls;
+                return std::pmr::new_delete_resource()->allocate(n, a);
+            }
+            void do_deallocate(void* p, size_t n, size_t a) override {
+                std::pmr::new_delete_resource()->deallocate(p, n, a);
+            }
+            bool do_is_equal(const std::pmr::memory_resource& o) const noexcept override { return this == &o; }
+        } mine, fallback;
+        std::string rendered;
+        {
+            std::pmr::memory_resource* previous = std::pmr::set_default_resource(&fallback);
+            auto root = parseParallel<JsonParser>(records, pool, 64, &mine);
+            std::pmr::set_default_resource(previous);
+            rendered = render(root);
+        }
+        bool ok = mine.calls > 0 && fallback.calls == 0 && rendered == render(JsonParser::parse(records));
+        std::cout << std::left << std::setw(38) << "[chunks use the caller's resource]"
+                  << " → " << (ok ? "PASS" : "FAIL") << '\n';
+    }
+
+    run_parallel_test<JsoncParser>(pool, {"[1, // a, b\n2, /* c, d */ 3, 4, 5, 6, 7, 8, 9]", "jsonc comments"});
+    run_parallel_test<BasicJsonParser<JsonParseOptions<true, false, true, true>>>(
+        pool, {members, "duplicate keys rejected"});
+
+    // Pretty-printing: same bytes as printJson for every layout option
+    struct FormatCase { bool compact; bool useColor; int indentStep; const char* description; };
+    std::vector<FormatCase> formats = {
+        {false, false, 2, "format pretty"},
+        {true,  false, 2, "format compact"},
+        {false, true,  4, "format color, indent 4"},
+    };
+    std::string nested = "{\"big\":" + records + ",\"map\":" + members + ",\"x\":[]}";
+    auto doc = JsonParser::parse(nested);
+    for (const auto& f : formats) {
+        std::cout << std::left << std::setw(38) << ("[" + std::string(f.description) + "]")
+                  << " → ";
+        std::ostringstream seq, par;
+        printJson(doc, seq, 0, f.indentStep, f.compact, f.useColor);
+        printJsonParallel(doc, par, pool, 0, f.indentStep, f.compact, f.useColor, 2);
+        std::cout << (seq.str() == par.str() ? "PASS\n" : "FAIL (output differs)\n");
+    }
+
+    return 0;
+}
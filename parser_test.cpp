@@ -3,6 +3,7 @@
 #include <string>
 #include <vector>
 #include <iomanip>
+#include <memory_resource>
 
 // Simple struct to hold test case info
 struct TestCase {
@@ -14,12 +15,13 @@ struct TestCase {
 };
 
 // Helper to print pass/fail nicely
+template <class Parser = JsonParser>
 void run_test(const TestCase& tc) {
     std::cout << std::left << std::setw(38) << ("[" + tc.description + "]")
               << " → ";
 
     try {
-        auto root = JsonParser::parse(tc.input);
+        auto root = Parser::parse(tc.input);
 
         if (!tc.should_succeed) {
             std::cout << "FAIL (parsed but should have thrown)\n";
@@ -101,6 +103,9 @@ int main() {
         {"NaN",              false, "NaN (not valid JSON)"},
         {"Infinity",         false, "Infinity (not valid JSON)"},
         {"[1 2 3]",          false, "missing commas (no auto-fix here)"},
+        {std::string(JsonParser::kMaxDepth, '[') + std::string(JsonParser::kMaxDepth, ']'),
+                             true,  "nesting at the depth cap",   JsonValue::Type::Array},
+        {std::string(300000, '['), false, "nesting past the depth cap"},
     };
 
     int passed = 0;
@@ -114,6 +119,89 @@ int main() {
         }
     }
 
+    // ── Compile-time parser options ───────────────────────────────────────
+    using LenientParser = BasicJsonParser<JsonParseOptions<false, false, false>>;
+    using UniqueKeyParser = BasicJsonParser<JsonParseOptions<true, false, true, true>>;
+
+    std::cout << "\n=== Parser Option Tests ===\n\n";
+    run_test<JsoncParser>({"/* c */ {\"a\": 1 // x\n}", true, "jsonc comments", JsonValue::Type::Object});
+    run_test<JsoncParser>({"[1 /* open", false, "jsonc unterminated comment"});
+    run_test<LenientParser>({"[1,2,]",   true,  "lenient trailing comma",    JsonValue::Type::Array});
+    run_test<LenientParser>({"1,",       true,  "lenient trailing content",  JsonValue::Type::Number});
+    run_test<UniqueKeyParser>({"{\"a\":1,\"a\":2}", false, "duplicate key rejected"});
+    run_test<UniqueKeyParser>({"{\"a\":1,\"b\":2}", true, "distinct keys accepted", JsonValue::Type::Object});
+    {
+        // A quote inside a comment must not flip --fix's string state.
+        const std::string doc = "{ // say \"hi\n \"a\": \"x] y\" /* \" */\n}";
+        bool ok = false;
+        try {
+            ok = JsoncParser::parse(correctJson(doc, true))->getObject().at("a")->getString() == "x] y";
+        } catch (const std::exception& e) {
+            std::cout << "  (exception: " << e.what() << ")\n";
+        }
+        std::cout << std::left << std::setw(38) << "[jsonc fix skips comments]"
+                  << " → " << (ok ? "PASS" : "FAIL") << "\n";
+    }
+
+    // ── Arena allocation ───────────────────────────────────────────────────
+    std::cout << "\n=== Memory Resource Tests ===\n\n";
+    {
+        // Upstream is the null resource: any allocation escaping the arena throws.
+        static char buffer[1 << 16];
+        std::pmr::monotonic_buffer_resource arena(buffer, sizeof buffer,
+                                                  std::pmr::null_memory_resource());
+        const char* doc = "{\"name\": \"a string well past the small-string buffer\","
+                          " \"list\": [1, 2.5, true, null, {\"k\": \"v\"}]}";
+        bool ok = false;
+        try {
+            auto root = JsonParser::parse(doc, &arena);
+            const auto& obj = root->getObject();
+            ok = obj.get_allocator().resource() == &arena &&
+                 obj.at("name")->getString().get_allocator().resource() == &arena &&
+                 obj.at("list")->getArray().size() == 5;
+        } catch (const std::exception& e) {
+            std::cout << "  (exception: " << e.what() << ")\n";
+        }
+        std::cout << std::left << std::setw(38) << "[parse into monotonic arena]"
+                  << " → " << (ok ? "PASS" : "FAIL") << "\n";
+    }
+
+    // ── Source lexemes ─────────────────────────────────────────────────────
+    std::cout << "\n=== Lexeme Tests ===\n\n";
+    {
+        using LenientLexemeParser = BasicJsonParser<JsonParseOptions<true, false, false, false, true>>;
+        const std::string doc = R"({"n": 1.50, "s": "a\u0062", "b": true})";
+        bool ok = false;
+        try {
+            auto root = JsonLexemeParser::parse(doc);
+            const auto& obj = root->getObject();
+            ok = obj.at("n")->getLexeme() == "1.50" && obj.at("n")->getNumber() == 1.5 &&
+                 obj.at("s")->getLexeme() == R"("a\u0062")" && obj.at("s")->getString() == "ab" &&
+                 obj.at("b")->getLexeme().empty() &&
+                 JsonParser::parse(doc)->getObject().at("n")->getLexeme().empty() &&
+                 LenientLexemeParser::parse("[01]")->getArray()[0]->getLexeme().empty();
+        } catch (const std::exception& e) {
+            std::cout << "  (exception: " << e.what() << ")\n";
+        }
+        std::cout << std::left << std::setw(38) << "[scalar lexemes recorded]"
+                  << " → " << (ok ? "PASS" : "FAIL") << "\n";
+    }
+    {
+        // Lexemes live in the number/string alternatives; setting and
+        // clearing one keeps the value.
+        JsonValue n(2.5), s(std::string("x")), b(true);
+        n.setLexeme("2.50");
+        s.setLexeme(R"("\u0078")");
+        b.setLexeme("true");
+        bool ok = n.getLexeme() == "2.50" && n.getNumber() == 2.5 && s.getLexeme() == R"("\u0078")"
+                  && s.getString() == "x" && b.getLexeme().empty();
+        n.setLexeme({});
+        s.setLexeme({});
+        ok = ok && n.getLexeme().empty() && n.getNumber() == 2.5 && s.getLexeme().empty() && s.getString() == "x";
+        std::cout << std::left << std::setw(38) << "[lexeme set and cleared]"
+                  << " → " << (ok ? "PASS" : "FAIL") << "\n";
+    }
+
     std::cout << "\nSummary: " << passed << " / " << total << " passed\n";
 
     return 0;
@@ -0,0 +1,207 @@
+// patch_test.cpp
+#include "jsonpatch.h"
+#include "jsonformatter.h"
+#include <iomanip>
+#include <iostream>
+#include <sstream>
+#include <string>
+
+void report(const std::string& description, bool ok) {
+    std::cout << std::left << std::setw(38) << ("[" + description + "]")
+              << " → " << (ok ? "PASS" : "FAIL") << '\n';
+}
+
+std::string compact(const std::shared_ptr<JsonValue>& v) {
+    std::ostringstream os;
+    printJson(v, os, 0, 2, true);
+    return os.str();
+}
+
+// Applies a JSON Patch in place and, when it qualifies, as a stream; both
+// must give `expected` (or both fail when it is empty).
+void expectPatch(const std::string& description, const std::string& doc, const std::string& patch,
+                 const std::string& expected) {
+    JsonPatch ops = parseJsonPatch(JsonParser::parse(patch));
+    bool ok = true;
+    std::string got;
+    try {
+        auto root = JsonParser::parse(doc);
+        applyJsonPatch(root, ops);
+        ok = !expected.empty() && jsonEqual(root, JsonParser::parse(expected));
+        got = compact(root);
+    } catch (const std::exception& e) {
+        ok = expected.empty();
+        got = e.what();
+    }
+    if (ok && canStreamJsonPatch(ops)) {
+        std::ostringstream out;
+        try {
+            streamJsonPatch(doc, ops, out);
+            ok = !expected.empty() && jsonEqual(JsonParser::parse(out.str()), JsonParser::parse(expected));
+            got = out.str();
+        } catch (const std::exception& e) {
+            ok = expected.empty() && out.str().empty();
+            got = std::string("stream: ") + e.what();
+        }
+    }
+    report(description, ok);
+    if (!ok) std::cout << "  got: " << got << '\n';
+}
+
+void expectMerge(const std::string& description, const std::string& doc, const std::string& patch,
+                 const std::string& expected) {
+    auto p = JsonParser::parse(patch);
+    auto root = JsonParser::parse(doc);
+    applyJsonMergePatch(root, p);
+    std::ostringstream out;
+    streamJsonMergePatch(doc, p, out);
+    auto want = JsonParser::parse(expected);
+    bool ok = jsonEqual(root, want) && jsonEqual(JsonParser::parse(out.str()), want);
+    report(description, ok);
+    if (!ok) std::cout << "  dom: " << compact(root) << "\n  stream: " << out.str() << '\n';
+}
+
+std::string stream(const std::string& doc, const std::string& patch) {
+    std::ostringstream out;
+    streamJsonPatch(doc, parseJsonPatch(JsonParser::parse(patch)), out);
+    return out.str();
+}
+
+bool streamable(const std::string& patch) {
+    return canStreamJsonPatch(parseJsonPatch(JsonParser::parse(patch)));
+}
+
+int main() {
+    std::cout << "=== JSON Patch Tests ===\n\n";
+
+    try {
+        // RFC 6902, Appendix A
+        expectPatch("add object member", R"({"foo": "bar"})",
+                    R"([{"op": "add", "path": "/baz", "value": "qux"}])", R"({"baz": "qux", "foo": "bar"})");
+        expectPatch("add array element", R"({"foo": ["bar", "baz"]})",
+                    R"([{"op": "add", "path": "/foo/1", "value": "qux"}])", R"({"foo": ["bar", "qux", "baz"]})");
+        expectPatch("remove object member", R"({"baz": "qux", "foo": "bar"})",
+                    R"([{"op": "remove", "path": "/baz"}])", R"({"foo": "bar"})");
+        expectPatch("remove array element", R"({"foo": ["bar", "qux", "baz"]})",
+                    R"([{"op": "remove", "path": "/foo/1"}])", R"({"foo": ["bar", "baz"]})");
+        expectPatch("replace value", R"({"baz": "qux", "foo": "bar"})",
+                    R"([{"op": "replace", "path": "/baz", "value": "boo"}])", R"({"baz": "boo", "foo": "bar"})");
+        expectPatch("move value", R"({"foo": {"bar": "baz", "waldo": "fred"}, "qux": {"corge": "grault"}})",
+                    R"([{"op": "move", "from": "/foo/waldo", "path": "/qux/thud"}])",
+                    R"({"foo": {"bar": "baz"}, "qux": {"corge": "grault", "thud": "fred"}})");
+        expectPatch("move array element", R"({"foo": ["all", "grass", "cows", "eat"]})",
+                    R"([{"op": "move", "from": "/foo/1", "path": "/foo/3"}])",
+                    R"({"foo": ["all", "cows", "eat", "grass"]})");
+        expectPatch("test success", R"({"baz": "qux", "foo": ["a", 2, "c"]})",
+                    R"([{"op": "test", "path": "/baz", "value": "qux"}, {"op": "test", "path": "/foo/1", "value": 2.0}])",
+                    R"({"baz": "qux", "foo": ["a", 2, "c"]})");
+        expectPatch("test failure", R"({"baz": "qux"})",
+                    R"([{"op": "test", "path": "/baz", "value": "bar"}])", "");
+        expectPatch("add nested member", R"({"foo": "bar"})",
+                    R"([{"op": "add", "path": "/child", "value": {"grandchild": {}}}])",
+                    R"({"foo": "bar", "child": {"grandchild": {}}})");
+        expectPatch("add to nonexistent target", R"({"foo": "bar"})",
+                    R"([{"op": "add", "path": "/baz/bat", "value": "qux"}])", "");
+        expectPatch("escape ordering", R"({"/": 9, "~1": 10})",
+                    R"([{"op": "test", "path": "/~01", "value": 10}])", R"({"/": 9, "~1": 10})");
+        expectPatch("add array value", R"({"foo": ["bar"]})",
+                    R"([{"op": "add", "path": "/foo/-", "value": ["abc", "def"]}])",
+                    R"({"foo": ["bar", ["abc", "def"]]})");
+        expectPatch("copy value", R"({"a": {"b": [1, 2]}, "c": {}})",
+                    R"([{"op": "copy", "from": "/a/b", "path": "/c/d"}])", R"({"a": {"b": [1, 2]}, "c": {"d": [1, 2]}})");
+        expectPatch("remove missing", R"({"a": 1})", R"([{"op": "remove", "path": "/b"}])", "");
+        expectPatch("index out of range", R"([1, 2])", R"([{"op": "add", "path": "/3", "value": 0}])", "");
+        expectPatch("replace whole document", R"({"a": 1})",
+                    R"([{"op": "replace", "path": "", "value": [true]}])", "[true]");
+        expectPatch("sequential array edits", R"([0, 1, 2, 3])",
+                    R"([{"op": "remove", "path": "/0"}, {"op": "remove", "path": "/0"}])", "[2, 3]");
+
+        bool threw = false;
+        try { parseJsonPatch(JsonParser::parse(R"([{"op": "jump", "path": "/a"}])")); } catch (const std::exception&) { threw = true; }
+        report("unknown op rejected", threw);
+        threw = false;
+        try { parseJsonPatch(JsonParser::parse(R"([{"op": "add", "path": "/a"}])")); } catch (const std::exception&) { threw = true; }
+        report("missing value rejected", threw);
+
+        std::cout << "\n=== Merge Patch Tests ===\n\n";
+        // RFC 7396, Appendix A
+        expectMerge("replace member", R"({"a": "b"})", R"({"a": "c"})", R"({"a": "c"})");
+        expectMerge("add member", R"({"a": "b"})", R"({"b": "c"})", R"({"a": "b", "b": "c"})");
+        expectMerge("null removes", R"({"a": "b"})", R"({"a": null})", "{}");
+        expectMerge("null removes one", R"({"a": "b", "b": "c"})", R"({"a": null})", R"({"b": "c"})");
+        expectMerge("array replaces array", R"({"a": ["b"]})", R"({"a": "c"})", R"({"a": "c"})");
+        expectMerge("nested merge", R"({"a": {"b": "c"}})", R"({"a": {"b": "d", "c": null}})", R"({"a": {"b": "d"}})");
+        expectMerge("object into scalar", R"({"a": [{"b": "c"}]})", R"({"a": [1]})", R"({"a": [1]})");
+        expectMerge("non-object target", R"(["a", "b"])", R"({"a": "b"})", R"({"a": "b"})");
+        expectMerge("non-object patch", R"({"a": "foo"})", R"(["c"])", R"(["c"])");
+        expectMerge("nulls dropped on insert", R"({"e": null})", R"({"a": {"bb": {"ccc": null}}})",
+                    R"({"e": null, "a": {"bb": {}}})");
+        expectMerge("missing null ignored", R"({"a": 1})", R"({"z": null})", R"({"a": 1})");
+
+        std::cout << "\n=== Streaming Tests ===\n\n";
+        const std::string doc = "{\n  \"name\": \"x\",\n  \"price\": 1.50,\n  \"tags\": [\"a\", \"b\"],\n  \"n\": 1e2\n}\n";
+        report("untouched bytes copied",
+               stream(doc, R"([{"op": "replace", "path": "/name", "value": "y"}])")
+                   == "{\n  \"name\": \"y\",\n  \"price\": 1.50,\n  \"tags\": [\"a\", \"b\"],\n  \"n\": 1e2\n}\n");
+        report("remove keeps layout",
+               stream(doc, R"([{"op": "remove", "path": "/price"}, {"op": "remove", "path": "/n"}])")
+                   == "{\n  \"name\": \"x\",\n  \"tags\": [\"a\", \"b\"]\n}\n");
+        report("append follows separators",
+               stream(doc, R"([{"op": "add", "path": "/z", "value": 0}, {"op": "add", "path": "/tags/-", "value": "c"}])")
+                   == "{\n  \"name\": \"x\",\n  \"price\": 1.50,\n  \"tags\": [\"a\", \"b\", \"c\"],\n  \"n\": 1e2,\n  \"z\": 0\n}\n");
+        report("move copies source text",
+               stream(doc, R"([{"op": "move", "from": "/price", "path": "/cost"}])")
+                   == "{\n  \"name\": \"x\",\n  \"tags\": [\"a\", \"b\"],\n  \"n\": 1e2,\n  \"cost\": 1.50\n}\n");
+        report("insert into empty array", stream("[]", R"([{"op": "add", "path": "/0", "value": 1}])") == "[1]");
+        report("inserted keys escaped",
+               stream("{}", R"([{"op": "add", "path": "/a", "value": {"q\"k\n": 1}}])") == R"({"a": {"q\"k\n":1}})");
+        {
+            // parsed with lexemes, as jsonify --patch does, numbers keep their spelling
+            const std::string text = R"([{"op": "add", "path": "/n", "value": [1e-7, 12345678901234567890]}])";
+            std::ostringstream os;
+            streamJsonPatch("{}", parseJsonPatch(JsonLexemeParser::parse(text)), os);
+            report("inserted numbers exact", os.str() == R"({"n": [1e-7,12345678901234567890]})");
+            const std::string merge = R"({"m": {"x": 1e-7}})";
+            os.str("");
+            streamJsonMergePatch("{}", JsonLexemeParser::parse(merge), os);
+            report("merged numbers exact", os.str() == R"({"m": {"x":1e-7}})");
+        }
+        report("remove every element", stream("[1]", R"([{"op": "remove", "path": "/0"}])") == "[]");
+        {
+            // with a repeated key only the last occurrence counts, as in the parser
+            std::ostringstream os;
+            streamJsonMergePatch(R"({"a":1,"a":2})", JsonParser::parse(R"({"a":9})"), os);
+            report("repeated key merged once", os.str() == R"({"a":9})");
+            report("repeated key replaced once",
+                   stream(R"({"a": 1, "x": 0, "a": 2})", R"([{"op": "replace", "path": "/a", "value": 9}])")
+                       == R"({"x": 0, "a": 9})");
+        }
+        expectMerge("repeated key merged into last", R"({"a": {"b": 0}, "a": {}})", R"({"a": {"b": 1}})",
+                    R"({"a": {"b": 1}})");
+        expectPatch("repeated key without the path", R"({"a": {"b": 0}, "a": {}})",
+                    R"([{"op": "replace", "path": "/a/b", "value": 1}])", "");
+
+        report("independent paths stream",
+               streamable(R"([{"op": "replace", "path": "/a/0", "value": 1}, {"op": "replace", "path": "/a/1", "value": 1}])"));
+        report("nested paths do not",
+               !streamable(R"([{"op": "add", "path": "/a", "value": {}}, {"op": "add", "path": "/a/b", "value": 1}])"));
+        report("shifted siblings do not",
+               !streamable(R"([{"op": "remove", "path": "/a/0"}, {"op": "replace", "path": "/a/2/x", "value": 1}])"));
+        report("root operations do not", !streamable(R"([{"op": "replace", "path": "", "value": 1}])"));
+
+        std::ostringstream out;
+        threw = false;
+        try {
+            streamJsonPatch(doc, parseJsonPatch(JsonParser::parse(
+                R"([{"op": "replace", "path": "/name", "value": 1}, {"op": "remove", "path": "/missing"}])")), out);
+        } catch (const std::exception&) { threw = true; }
+        report("failed stream writes nothing", threw && out.str().empty());
+
+        threw = false;
+        try { stream("[1, 2", R"([{"op": "remove", "path": "/0"}])"); } catch (const std::exception&) { threw = true; }
+        report("syntax error while streaming", threw);
+    } catch (const std::exception& e) {
+        std::cout << "FAIL (exception: " << e.what() << ")\n";
+    }
+    return 0;
+}
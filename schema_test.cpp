@@ -0,0 +1,130 @@
+// schema_test.cpp
+#include "jsonschema.h"
+#include <algorithm>
+#include <cstdlib>
+#include <filesystem>
+#include <fstream>
+#include <iomanip>
+#include <iostream>
+#include <string>
+#include <vector>
+
+void report(const std::string& description, bool ok) {
+    std::cout << std::left << std::setw(38) << ("[" + description + "]")
+              << " → " << (ok ? "PASS" : "FAIL") << '\n';
+}
+
+// Sorted "path: message" lines; DOM and streaming validation must agree.
+std::vector<std::string> lines(const std::vector<JsonSchemaError>& errors) {
+    std::vector<std::string> out;
+    for (const auto& e : errors) out.push_back(e.path + ": " + e.message);
+    std::sort(out.begin(), out.end());
+    return out;
+}
+
+void expect(const std::string& description, const JsonSchema& schema, const std::string& json,
+            const std::vector<std::string>& expected) {
+    auto dom = lines(schema.validate(JsonParser::parse(json)));
+    auto stream = lines(schema.validate(std::string_view(json)));
+    report(description, dom == expected && stream == expected);
+    if (dom != expected || stream != expected) {
+        for (const auto& l : dom) std::cout << "  dom:    " << l << '\n';
+        for (const auto& l : stream) std::cout << "  stream: " << l << '\n';
+    }
+}
+
+int main(int argc, char** argv) {
+    std::cout << "=== JSON Schema Tests ===\n\n";
+
+    try {
+        JsonSchema schema = JsonSchema::compile(JsonParser::parse(R"({
+            "type": "object",
+            "required": ["id", "name"],
+            "additionalProperties": false,
+            "properties": {
+                "id":    {"type": "integer", "minimum": 1},
+                "name":  {"type": "string", "minLength": 2, "maxLength": 4, "pattern": "^[a-z]"},
+                "ratio": {"type": "number", "exclusiveMaximum": 1},
+                "tags":  {"type": "array", "items": {"enum": ["a", "b"]}, "maxItems": 2},
+                "kind":  {"const": {"x": [1, 2]}},
+                "a/b":   {"type": ["null", "boolean"]},
+                "any":   true,
+                "none":  false
+            }
+        })"));
+
+        expect("valid document", schema, R"({"id": 1, "name": "hélo"})", {});
+        expect("missing required", schema, R"({"id": 1})", {": Missing required property \"name\""});
+        expect("wrong type", schema, R"({"id": 1.5, "name": "ab"})", {"/id: Expected integer, got number"});
+        expect("number bounds", schema, R"({"id": 0, "name": "ab", "ratio": 1})",
+               {"/id: Number is below minimum 1", "/ratio: Number must be less than 1"});
+        expect("string length and pattern", schema, R"({"id": 1, "name": "Abcde"})",
+               {"/name: String does not match pattern \"^[a-z]\"", "/name: String is longer than maxLength 4"});
+        expect("array items and size", schema, R"({"id": 1, "name": "ab", "tags": ["a", "c", "b"]})",
+               {"/tags/1: Value is not in enum", "/tags: Array has more than 2 items"});
+        expect("container const", schema, R"({"id": 1, "name": "ab", "kind": {"x": [1, 3]}})",
+               {"/kind: Value is not in enum"});
+        expect("container const matches", schema, R"({"id": 1, "name": "ab", "kind": {"x": [1, 2]}})", {});
+        expect("additional property", schema, R"({"id": 1, "name": "ab", "zz": 0})", {"/zz: Property is not allowed"});
+        expect("escaped pointer, type list", schema, R"({"id": 1, "name": "ab", "a/b": 3})",
+               {"/a~1b: Expected null or boolean, got integer"});
+        expect("true and false schemas", schema, R"({"id": 1, "name": "ab", "any": [], "none": 0})",
+               {"/none: No value is allowed here"});
+        expect("root type", schema, "[]", {": Expected object, got array"});
+
+        bool threw = false;
+        try { schema.validate(std::string_view(R"({"id": 1,})")); } catch (const std::exception&) { threw = true; }
+        report("stream rejects bad syntax", threw);
+
+        threw = false;
+        try { JsonSchema::compile(JsonParser::parse(R"({"type": "text"})")); } catch (const std::exception&) { threw = true; }
+        report("unknown type in schema", threw);
+
+        // A backtracking matcher recurses per character and overflows the
+        // stack on strings this long; the pattern VM does not.
+        JsonSchema ab = JsonSchema::compile(JsonParser::parse(R"({"type": "string", "pattern": "^(a|b)*$"})"));
+        std::string longText(200000, 'a');
+        for (size_t i = 0; i < longText.size(); i += 3) longText[i] = 'b';
+        expect("long string matches pattern", ab, "\"" + longText + "\"", {});
+        expect("long string fails pattern", ab, "\"" + longText + "c\"",
+               {": String does not match pattern \"^(a|b)*$\""});
+        expect("pattern matches code points", JsonSchema::compile(JsonParser::parse(R"({"pattern": "^.$"})")),
+               "\"\u00e9\"", {});
+        JsonSchema lookahead = JsonSchema::compile(JsonParser::parse(R"j({"pattern": "^(?!x)"})j"));
+        expect("backtracking pattern, short input", lookahead, R"("abc")", {});
+        expect("backtracking pattern, long input", lookahead, "\"" + longText + "\"",
+               {": String is too long for pattern \"^(?!x)\" (over 4096 bytes)"});
+
+        threw = false;
+        try { JsonSchema::compile(JsonParser::parse(R"({"pattern": "(a"})")); } catch (const std::exception&) { threw = true; }
+        report("invalid pattern in schema", threw);
+    } catch (const std::exception& e) {
+        std::cout << "FAIL (exception: " << e.what() << ")\n";
+    }
+
+    // --jsonc --schema through the CLI: the streaming validator does not skip
+    // comments, so the tool must validate the parsed tree. Needs the jsonify
+    // executable (first argument, default ./jsonify).
+    namespace fs = std::filesystem;
+    const std::string exe = argc > 1 ? argv[1] : "./jsonify";
+    if (!fs::exists(exe)) {
+        std::cout << "(" << exe << " not found, skipping --jsonc --schema run test)\n";
+    } else {
+        fs::path dir = fs::temp_directory_path() / "jsonify_schema_test";
+        fs::create_directories(dir);
+        std::ofstream(dir / "schema.json") << R"({"type": "object", "required": ["id"]})";
+        std::ofstream(dir / "good.jsonc") << "{\"id\": 1 /* one */} // done\n";
+        std::ofstream(dir / "bad.jsonc") << "{\"name\": \"x\"} // no id\n";
+        std::ofstream(dir / "records.jsonc") << "{\"id\": 1} // first\n{\"id\": 2 /* second */}\n";
+        auto run = [&](const std::string& args) {
+            return std::system((exe + " -q --jsonc --schema " + (dir / "schema.json").string() + " " + args
+                                + " > " + (dir / "out.txt").string() + " 2>&1").c_str());
+        };
+        report("jsonc document validates", run((dir / "good.jsonc").string()) == 0);
+        report("jsonc document fails schema", run((dir / "bad.jsonc").string()) != 0);
+        report("jsonc records validate", run("--ndjson " + (dir / "records.jsonc").string()) == 0);
+        fs::remove_all(dir);
+    }
+
+    return 0;
+}
@@ -0,0 +1,211 @@
+// server_test.cpp
+#include "jsonserver.h"
+#include "threadpool.h"
+#include <chrono>
+#include <filesystem>
+#include <fstream>
+#include <iomanip>
+#include <iostream>
+#include <string>
+#include <thread>
+#include <vector>
+
+#ifndef _WIN32
+#  include <sys/socket.h>
+#  include <sys/un.h>
+#  include <unistd.h>
+#endif
+
+void report(const std::string& description, bool ok) {
+    std::cout << std::left << std::setw(38) << ("[" + description + "]")
+              << " → " << (ok ? "PASS" : "FAIL") << '\n';
+}
+
+void expect(const std::string& description, JsonServer& server, const std::string& request,
+            const std::string& expected) {
+    std::string got = server.handle(request);
+    report(description, got == expected);
+    if (got != expected) std::cout << "  got: " << got << '\n';
+}
+
+void writeFile(const std::string& path, const std::string& text) {
+    std::ofstream(path, std::ios::binary) << text;
+}
+
+#ifndef _WIN32
+// Connects to the server's socket, retrying while it starts up; -1 on failure.
+int connectTo(const std::string& path) {
+    sockaddr_un addr{};
+    addr.sun_family = AF_UNIX;
+    path.copy(addr.sun_path, sizeof addr.sun_path - 1);
+    for (int attempt = 0; attempt < 200; ++attempt) {
+        int fd = ::socket(AF_UNIX, SOCK_STREAM, 0);
+        if (::connect(fd, reinterpret_cast<sockaddr*>(&addr), sizeof addr) == 0) {
+            timeval timeout{5, 0};   // a starved client fails instead of hanging the test
+            ::setsockopt(fd, SOL_SOCKET, SO_RCVTIMEO, &timeout, sizeof timeout);
+            return fd;
+        }
+        ::close(fd);
+        std::this_thread::sleep_for(std::chrono::milliseconds(10));
+    }
+    return -1;
+}
+
+bool sendAll(int fd, const std::string& text) {
+    return ::write(fd, text.data(), text.size()) == static_cast<ssize_t>(text.size());
+}
+
+// Reads until `n` response lines have arrived or the server hangs up.
+std::vector<std::string> readLines(int fd, size_t n) {
+    std::vector<std::string> lines;
+    std::string buffer;
+    char chunk[4096];
+    while (lines.size() < n) {
+        ssize_t got = ::read(fd, chunk, sizeof chunk);
+        if (got <= 0) break;
+        buffer.append(chunk, static_cast<size_t>(got));
+        size_t nl;
+        while ((nl = buffer.find('\n')) != std::string::npos) {
+            lines.push_back(buffer.substr(0, nl));
+            buffer.erase(0, nl + 1);
+        }
+    }
+    return lines;
+}
+
+// A served socket: one worker thread, an idle client holding a connection,
+// and several clients pipelining requests at once.
+void socketTests(const std::string& dir) {
+    const std::string sock = dir + "/server.sock";
+    ThreadPool pool(1);
+    JsonServerOptions opt;
+    opt.maxRequestBytes = 4096;
+    JsonServer server(pool, opt);
+    std::string serveError;
+    std::thread serving([&] {
+        try { server.serve(sock); } catch (const std::exception& e) { serveError = e.what(); }
+    });
+
+    int idle = connectTo(sock);
+    report("client connects", idle >= 0);
+
+    const int clients = 4, requests = 25;
+    std::vector<char> inOrder(clients, 0);   // not vector<bool>: threads write neighbouring flags
+    std::vector<std::thread> threads;
+    for (int k = 0; k < clients; ++k) {
+        threads.emplace_back([&, k] {
+            int fd = connectTo(sock);
+            if (fd < 0) return;
+            std::string batch;
+            for (int i = 0; i < requests; ++i)
+                batch += R"({"id": )" + std::to_string(i) + R"(, "op": "format", "content": "[)"
+                         + std::to_string(k) + R"(]", "compact": true})" + "\n";
+            std::vector<std::string> lines;
+            if (sendAll(fd, batch)) lines = readLines(fd, requests);
+            bool ok = lines.size() == size_t(requests);
+            for (int i = 0; ok && i < requests; ++i)
+                ok = lines[i] == R"({"id":)" + std::to_string(i) + R"(,"ok":true,"output":"[)"
+                                 + std::to_string(k) + R"(]"})";
+            inOrder[k] = ok;
+            ::close(fd);
+        });
+    }
+    for (auto& t : threads) t.join();
+    report("concurrent clients, one worker", inOrder == std::vector<char>(clients, 1));
+
+    int longFd = connectTo(sock);
+    std::vector<std::string> longReply;
+    if (longFd >= 0 && sendAll(longFd, R"({"op": "format", "content": ")" + std::string(8192, ' ')))
+        longReply = readLines(longFd, 2);   // the error, then the server hangs up
+    report("overlong request line", longReply.size() == 1
+           && longReply[0] == R"({"ok":false,"error":"Request line is longer than 4096 bytes"})");
+    if (longFd >= 0) ::close(longFd);
+
+    bool refused = false;
+    try {
+        JsonServer second(pool);
+        second.serve(sock);
+    } catch (const std::exception&) { refused = true; }
+    report("live socket is not taken over", refused);
+
+    int fd = connectTo(sock);
+    std::vector<std::string> bye;
+    if (fd >= 0 && sendAll(fd, "{\"id\": 9, \"op\": \"shutdown\"}\n")) bye = readLines(fd, 1);
+    serving.join();
+    report("shutdown is acknowledged", bye.size() == 1 && bye[0] == R"({"id":9,"ok":true})");
+    report("socket removed on exit", serveError.empty() && !std::filesystem::exists(sock));
+    if (fd >= 0) ::close(fd);
+    if (idle >= 0) ::close(idle);
+}
+#endif
+
+int main() {
+    std::cout << "=== Server Tests ===\n\n";
+
+    namespace fs = std::filesystem;
+    const std::string dir = (fs::temp_directory_path() / "jsonify_server_test").string();
+    fs::remove_all(dir);
+    fs::create_directories(dir);
+    const std::string doc = dir + "/doc.json";
+    writeFile(doc, R"({"users": [{"name": "ann"}], "n": 1})");
+
+    try {
+        ThreadPool pool(2);
+        JsonServerOptions opt;
+        opt.cacheBytes = 64;
+        JsonServer server(pool, opt);
+
+        expect("ping", server, R"({"id": 1, "op": "ping"})", R"({"id":1,"ok":true})");
+        expect("lint inline content", server, R"({"op": "lint", "content": "{\"a\": [1, 2]}"})",
+               R"({"ok":true,"issues":[]})");
+        expect("format inline content", server, R"({"id": 2, "op": "format", "content": "[1, {\"a\": 2}]", "compact": true})",
+               R"({"id":2,"ok":true,"output":"[1,{\"a\":2}]"})");
+        expect("format jsonc", server, R"({"op": "format", "content": "[1 /* c */]", "jsonc": true, "indent": 4})",
+               R"({"ok":true,"output":"[\n    1\n]"})");
+        expect("query file", server, R"({"id": 3, "op": "query", "path": ")" + doc + R"(", "pointer": "/users/0"})",
+               R"({"id":3,"ok":true,"value":{"name":"ann"}})");
+        report("file document is cached", server.cachedDocuments() == 1);
+
+        // Same size, different content: the cached tree must not be reused.
+        auto stamp = fs::last_write_time(doc);
+        writeFile(doc, R"({"users": [{"name": "bob"}], "n": 2})");
+        fs::last_write_time(doc, stamp + std::chrono::seconds(2));
+        expect("changed file is reparsed", server, R"({"op": "query", "path": ")" + doc + R"(", "pointer": "/n"})",
+               R"({"ok":true,"value":2})");
+
+        const std::string other = dir + "/other.json";
+        writeFile(other, R"({"padding": "xxxxxxxxxxxxxxxxxxxxxxxxxxxxxx"})");
+        server.handle(R"({"op": "lint", "path": ")" + other + R"("})");
+        report("cache evicts past its budget", server.cachedDocuments() == 1);
+
+        expect("syntax error", server, R"({"id": 4, "op": "lint", "content": "[1,]"})",
+               R"x({"id":4,"ok":false,"error":"Unexpected character ']' (line 1, col 4)"})x");
+        expect("missing path", server, R"({"id": 5, "op": "query", "path": ")" + dir + R"(/none.json"})",
+               R"({"id":5,"ok":false,"error":"Cannot open )" + dir + R"(/none.json"})");
+        expect("bad pointer", server, R"({"op": "query", "content": "{}", "pointer": "/a"})",
+               R"({"ok":false,"error":"No such path: /a"})");
+        expect("unknown op", server, R"({"op": "eval"})", R"({"ok":false,"error":"Unknown op \"eval\""})");
+        expect("indent is capped", server, R"({"op": "format", "content": "[1]", "indent": 1000000000})",
+               R"({"ok":false,"error":"\"indent\" must be between 0 and 16"})");
+        const std::string deep(300000, '[');
+        expect("deep nesting is rejected", server, R"({"id": 6, "op": "lint", "content": ")" + deep + R"("})",
+               R"x({"id":6,"ok":false,"error":"Nesting too deep (line 1, col 4097)"})x");
+        expect("deep unknown field", server, R"({"op": "ping", "x": )" + deep + "}",
+               R"x({"ok":false,"error":"Bad request: Nesting too deep (line 1, col 4117)"})x");
+        expect("malformed request", server, R"({"id": 1)",
+               R"x({"ok":false,"error":"Bad request: Unexpected end of input (line 1, col 9)"})x");
+    } catch (const std::exception& e) {
+        std::cout << "FAIL (exception: " << e.what() << ")\n";
+    }
+
+#ifndef _WIN32
+    try {
+        socketTests(dir);
+    } catch (const std::exception& e) {
+        std::cout << "FAIL (exception: " << e.what() << ")\n";
+    }
+#endif
+
+    fs::remove_all(dir);
+    return 0;
+}
@@ -0,0 +1,131 @@
+#include "threadpool.h"
+
+namespace {
+// Index of the worker running on this thread in its pool, or npos.
+thread_local const ThreadPool* tlsPool = nullptr;
+thread_local size_t            tlsIndex = static_cast<size_t>(-1);
+}
+
+/* --------------------------------------------------------------- */
+ThreadPool::ThreadPool(size_t threads) {
+    if (threads == 0) threads = std::thread::hardware_concurrency();
+    if (threads == 0) threads = 1;
+    for (size_t i = 0; i < threads; ++i) queues_.push_back(std::make_unique<Queue>());
+    workers_.reserve(threads);
+    for (size_t i = 0; i < threads; ++i) workers_.emplace_back([this, i] { workerLoop(i); });
+}
+
+ThreadPool::~ThreadPool() {
+    {
+        std::lock_guard<std::mutex> lock(sleepMutex_);
+        stop_ = true;
+    }
+    sleepCv_.notify_all();
+    for (auto& t : workers_) t.join();
+}
+
+/* --------------------------------------------------------------- */
+void ThreadPool::submit(std::function<void()> task) {
+    size_t q = (tlsPool == this) ? tlsIndex : nextQueue_++ % queues_.size();
+    // Count the task before it becomes visible: a thief that pops it at once
+    // must not decrement pending_ below zero.
+    {
+        std::lock_guard<std::mutex> lock(sleepMutex_);
+        ++pending_;
+    }
+    {
+        std::lock_guard<std::mutex> lock(queues_[q]->m);
+        queues_[q]->tasks.push_back(std::move(task));
+    }
+    sleepCv_.notify_one();
+}
+
+/* --------------------------------------------------------------- */
+bool ThreadPool::popTask(size_t self, std::function<void()>& task) {
+    // own queue first, newest task (LIFO)
+    if (self < queues_.size()) {
+        Queue& own = *queues_[self];
+        std::lock_guard<std::mutex> lock(own.m);
+        if (!own.tasks.empty()) {
+            task = std::move(own.tasks.back());
+            own.tasks.pop_back();
+            --pending_;
+            return true;
+        }
+    }
+    // then steal the oldest task from someone else (FIFO)
+    size_t n = queues_.size();
+    size_t start = (self < n) ? self + 1 : 0;
+    for (size_t k = 0; k < n; ++k) {
+        Queue& victim = *queues_[(start + k) % n];
+        std::lock_guard<std::mutex> lock(victim.m);
+        if (!victim.tasks.empty()) {
+            task = std::move(victim.tasks.front());
+            victim.tasks.pop_front();
+            --pending_;
+            return true;
+        }
+    }
+    return false;
+}
+
+bool ThreadPool::runPending() {
+    std::function<void()> task;
+    size_t self = (tlsPool == this) ? tlsIndex : static_cast<size_t>(-1);
+    if (!popTask(self, task)) return false;
+    task();
+    return true;
+}
+
+/* --------------------------------------------------------------- */
+void ThreadPool::workerLoop(size_t index) {
+    tlsPool  = this;
+    tlsIndex = index;
+    std::function<void()> task;
+    while (true) {
+        if (popTask(index, task)) {
+            task();
+            task = nullptr;
+            continue;
+        }
+        std::unique_lock<std::mutex> lock(sleepMutex_);
+        sleepCv_.wait(lock, [this] { return stop_ || pending_ > 0; });
+        if (stop_ && pending_ == 0) return;
+    }
+}
+
+/* --------------------------------------------------------------- */
+TaskGroup::~TaskGroup() {
+    try { wait(); } catch (...) {}
+}
+
+void TaskGroup::run(std::function<void()> task) {
+    ++outstanding_;
+    pool_.submit([this, task = std::move(task)] {
+        try {
+            task();
+        } catch (...) {
+            std::lock_guard<std::mutex> lock(m_);
+            if (!error_) error_ = std::current_exception();
+        }
+        std::lock_guard<std::mutex> lock(m_);
+        if (--outstanding_ == 0) cv_.notify_all();
+    });
+}
+
+void TaskGroup::wait() {
+    // Help until the queues are empty. After that every task of the group is
+    // already running on some thread (they are all run() before wait()), so
+    // sleeping until the last one signals cannot hold anything up.
+    while (outstanding_ > 0) {
+        if (pool_.runPending()) continue;
+        std::unique_lock<std::mutex> lock(m_);
+        cv_.wait(lock, [this] { return outstanding_ == 0; });
+    }
+    std::lock_guard<std::mutex> lock(m_);
+    if (error_) {
+        std::exception_ptr e = error_;
+        error_ = nullptr;
+        std::rethrow_exception(e);
+    }
+}
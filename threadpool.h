@@ -0,0 +1,71 @@
+#ifndef THREADPOOL_H
+#define THREADPOOL_H
+
+#include <atomic>
+#include <condition_variable>
+#include <deque>
+#include <exception>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+// Work-stealing thread pool. Each worker owns a deque: it pushes and pops its
+// own tasks at the back (LIFO, cache-warm) and steals from the front of other
+// workers' deques when it runs dry. Tasks submitted from outside the pool are
+// spread round-robin.
+class ThreadPool {
+public:
+    explicit ThreadPool(size_t threads = 0);   // 0 = hardware concurrency
+    ~ThreadPool();
+    ThreadPool(const ThreadPool&) = delete;
+    ThreadPool& operator=(const ThreadPool&) = delete;
+
+    size_t size() const { return workers_.size(); }
+    void submit(std::function<void()> task);
+
+    // Runs one queued task on the calling thread, if any; used by waiters so
+    // that nested parallelism cannot deadlock the pool.
+    bool runPending();
+
+private:
+    struct Queue {
+        std::mutex m;
+        std::deque<std::function<void()>> tasks;
+    };
+
+    bool popTask(size_t self, std::function<void()>& task);
+    void workerLoop(size_t index);
+
+    std::vector<std::unique_ptr<Queue>> queues_;
+    std::vector<std::thread> workers_;
+    std::atomic<size_t> pending_{0};
+    std::atomic<size_t> nextQueue_{0};
+    std::atomic<bool>   stop_{false};
+    std::mutex              sleepMutex_;
+    std::condition_variable sleepCv_;
+};
+
+// A set of tasks that can be waited on together. wait() helps run queued
+// work, then blocks until the group is done, and rethrows the first exception
+// thrown by any task in the group. Tasks are added with run() before wait().
+class TaskGroup {
+public:
+    explicit TaskGroup(ThreadPool& pool) : pool_(pool) {}
+    ~TaskGroup();
+    TaskGroup(const TaskGroup&) = delete;
+    TaskGroup& operator=(const TaskGroup&) = delete;
+
+    void run(std::function<void()> task);
+    void wait();
+
+private:
+    ThreadPool& pool_;
+    std::atomic<size_t> outstanding_{0};
+    std::mutex              m_;
+    std::condition_variable cv_;
+    std::exception_ptr      error_;
+};
+
+#endif
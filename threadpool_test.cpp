@@ -0,0 +1,51 @@
+// threadpool_test.cpp
+#include "threadpool.h"
+#include <atomic>
+#include <iomanip>
+#include <iostream>
+#include <stdexcept>
+#include <string>
+
+void report(const std::string& description, bool ok) {
+    std::cout << std::left << std::setw(38) << ("[" + description + "]")
+              << " → " << (ok ? "PASS" : "FAIL") << '\n';
+}
+
+int main() {
+    std::cout << "=== Thread Pool Tests ===\n\n";
+
+    ThreadPool pool(4);
+
+    {
+        std::atomic<int> sum{0};
+        TaskGroup group(pool);
+        for (int i = 1; i <= 1000; ++i) group.run([&sum, i] { sum += i; });
+        group.wait();
+        report("all tasks run", sum == 500500);
+    }
+
+    {
+        // nested groups must not deadlock even when every worker is waiting
+        std::atomic<int> leaves{0};
+        TaskGroup outer(pool);
+        for (int i = 0; i < 16; ++i) {
+            outer.run([&] {
+                TaskGroup inner(pool);
+                for (int j = 0; j < 16; ++j) inner.run([&] { ++leaves; });
+                inner.wait();
+            });
+        }
+        outer.wait();
+        report("nested groups", leaves == 256);
+    }
+
+    {
+        TaskGroup group(pool);
+        group.run([] { throw std::runtime_error("boom"); });
+        bool caught = false;
+        try { group.wait(); } catch (const std::runtime_error&) { caught = true; }
+        report("exception propagates to wait()", caught);
+    }
+
+    return 0;
+}